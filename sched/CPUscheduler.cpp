@@ -1,6 +1,7 @@
 /*************************************************************************************
  *  CPU Scheduler (Multiple Algorithms)
- *  Algorithms: LJF, FCFS, SJF, Round Robin, Priority, SRTF
+ *  Algorithms: LJF, FCFS, SJF, Round Robin, Priority, SRTF, CFS,
+ *              Priority with aging, MLFQ
  ************************************************************************************/
 #include <iostream>
 #include <fstream>
@@ -8,417 +9,1828 @@
 #include <algorithm>
 #include <sstream>
 #include <queue>
+#include <deque>
+#include <set>
 #include <climits>
+#include <cstdint>
+#include <string_view>
+#include <charconv>
+#include <cstring>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <tuple>
+#include <memory>
+#include <iomanip>
+#include <array>
+#include <cmath>
+#include <random>
+#include <chrono>
+#include <atomic>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "scheduler.h"
 using namespace std;
 
-struct Process {
-    string name;
-    int arrivalTime;
-    int processingTime;
-    int remainingTime;
-    int priority;
-    int responseTime;
-    int turnaround;
-    int delay;
-    int startTime;
-    bool hasStarted;
+using cpusched::NameTable;
+using cpusched::ProcessTable;
+using cpusched::TraceSegment;
+using cpusched::LatencyHistogram;
+using cpusched::RunStats;
+using cpusched::RunContext;
+using cpusched::Policy;
+using cpusched::POLICY_COUNT;
+using cpusched::POLICY_NAMES;
+using cpusched::CfsConfig;
+using cpusched::AgingConfig;
+using cpusched::MlfqConfig;
+using cpusched::Simulator;
+using cpusched::IncrementalRun;
+
+const char* const POLICY_OUTPUT_FILES[POLICY_COUNT] = {
+    "out_fcfs.txt", "out_sjf.txt", "out_ljf.txt", "out_rr.txt", "out_priority.txt",
+    "out_srtf.txt", "out_cfs.txt", "out_priority_aging.txt", "out_mlfq.txt",
+};
+
+enum class TraceFormat {
+    Legacy,    // concatenated names, as the scheduler has always written
+    Segments   // one "name start end" line per segment
+};
+
+/*************************************************************************************
+ *  Trace loading
+ *  Text traces: a process count line, then "name arrival burst [priority]"
+ *  lines. Binary traces: BinaryTraceHeader followed by the columns.
+ ************************************************************************************/
+// Read-only mapping of a whole file
+class MappedFile {
+private:
+    const char* base = nullptr;
+    size_t length = 0;
+
+public:
+    explicit MappedFile(const string& filename) {
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0) return;
+        struct stat st;
+        if (fstat(fd, &st) == 0) {
+            if (st.st_size == 0) {
+                base = "";  // empty file: nothing to map
+            } else {
+                void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (p != MAP_FAILED) {
+                    madvise(p, st.st_size, MADV_SEQUENTIAL);
+                    base = static_cast<const char*>(p);
+                    length = st.st_size;
+                }
+            }
+        }
+        close(fd);
+    }
+    
+    ~MappedFile() {
+        if (length) munmap(const_cast<char*>(base), length);
+    }
+    
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    
+    bool isOpen() const { return base != nullptr; }
+    const char* data() const { return base; }
+    size_t size() const { return length; }
+};
+
+struct BinaryTraceHeader {
+    char magic[8];          // "SCHEDTR\0"
+    uint32_t version;       // 1
+    uint32_t hasPriority;   // priority column holds values read from the trace
+    uint64_t count;
+    uint64_t nameBytes;
+    // then: int32 arrival[count], int32 burst[count], int32 priority[count],
+    //       uint32 nameOffsets[count + 1], char names[nameBytes]
+};
+const char BINARY_TRACE_MAGIC[8] = {'S', 'C', 'H', 'E', 'D', 'T', 'R', 0};
+
+inline bool isBlank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+inline bool isBlankLine(const char* p, const char* end) {
+    while (p < end && isBlank(*p)) p++;
+    return p == end;
+}
+
+inline const char* lineEnd(const char* p, const char* end) {
+    const char* nl = static_cast<const char*>(memchr(p, '\n', end - p));
+    return nl ? nl : end;
+}
+
+// Parse "name arrival burst [priority]". Returns false on a malformed line.
+// As with the original stream reader, a fourth token that is not a number
+// means no priority, and anything after the last field read is ignored.
+inline bool parseTraceLine(const char* p, const char* end, string_view& name,
+                           int& arrival, int& burst, int& priority, bool& hasPriority) {
+    while (p < end && isBlank(*p)) p++;
+    const char* nameStart = p;
+    while (p < end && !isBlank(*p)) p++;
+    name = string_view(nameStart, p - nameStart);
     
-    Process(string name, int arrivalTime, int processingTime, int priority = 0) :
-       name(name), arrivalTime(arrivalTime), processingTime(processingTime),
-       remainingTime(processingTime), priority(priority),
-       responseTime(0), turnaround(0), delay(0), startTime(-1), hasStarted(false) {}
+    int* fields[3] = {&arrival, &burst, &priority};
+    for (int f = 0; f < 3; f++) {
+        while (p < end && isBlank(*p)) p++;
+        auto [next, ec] = from_chars(p, end, *fields[f]);
+        if (ec != errc() || (next < end && !isBlank(*next))) {
+            hasPriority = false;
+            return f == 2;  // priority is optional
+        }
+        p = next;
+    }
+    hasPriority = true;
+    return true;
+}
+
+// Parse a text trace with one thread per line-aligned slice of the file. A
+// first pass counts the lines in each slice so every thread knows the row
+// its slice starts at; the second pass parses straight into the
+// pre-sized columns. Names go to per-slice buffers that are then copied
+// into the name arena at their final offsets.
+inline bool parseTextTrace(const char* begin, const char* end, bool readPriority,
+                           ProcessTable& table, string& error) {
+    const char* headerEnd = lineEnd(begin, end);
+    const char* p = begin;
+    while (p < headerEnd && isBlank(*p)) p++;
+    long long declared = 0;
+    if (from_chars(p, headerEnd, declared).ec != errc() || declared < 0 || declared > UINT32_MAX) {
+        error = "missing or invalid process count";
+        return false;
+    }
+    const char* body = headerEnd < end ? headerEnd + 1 : end;
+    size_t count = declared;
     
-    // Comparators
-    static bool compareLJF(const Process& p1, const Process& p2) {
-        if (p1.processingTime != p2.processingTime)
-            return p1.processingTime > p2.processingTime;
-        return p1.arrivalTime < p2.arrivalTime;
+    unsigned slices = max<size_t>(1, min<size_t>(thread::hardware_concurrency(), (end - body) / (1 << 20) + 1));
+    vector<const char*> cuts(slices + 1, end);
+    cuts[0] = body;
+    for (unsigned t = 1; t < slices; t++) {
+        const char* cut = max(cuts[t - 1], body + (end - body) / slices * t);
+        cuts[t] = cut < end ? min(end, lineEnd(cut, end) + 1) : end;
     }
     
-    static bool compareSJF(const Process& p1, const Process& p2) {
-        if (p1.processingTime != p2.processingTime)
-            return p1.processingTime < p2.processingTime;
-        return p1.arrivalTime < p2.arrivalTime;
+    vector<size_t> lines(slices, 0);
+    vector<thread> threads;
+    for (unsigned t = 0; t < slices; t++) {
+        threads.emplace_back([&, t] {
+            for (const char* q = cuts[t]; q < cuts[t + 1];) {
+                const char* e = lineEnd(q, cuts[t + 1]);
+                if (!isBlankLine(q, e)) lines[t]++;
+                q = e + 1;
+            }
+        });
+    }
+    for (auto& th : threads) th.join();
+    threads.clear();
+    
+    vector<size_t> firstRow(slices + 1, 0);
+    for (unsigned t = 0; t < slices; t++) firstRow[t + 1] = firstRow[t] + lines[t];
+    if (firstRow[slices] < count) {
+        error = "declares " + to_string(count) + " processes but has " + to_string(firstRow[slices]);
+        return false;
     }
     
-    static bool compareFCFS(const Process& p1, const Process& p2) {
-        return p1.arrivalTime < p2.arrivalTime;
+    table.resizeInput(count);
+    vector<uint32_t> nameLength(count);
+    vector<vector<char>> sliceNames(slices);
+    vector<string> sliceError(slices);
+    for (unsigned t = 0; t < slices; t++) {
+        threads.emplace_back([&, t] {
+            size_t row = firstRow[t];
+            string_view name;
+            int arrival, burst, priority;
+            bool hasPriority;
+            for (const char* q = cuts[t]; q < cuts[t + 1] && row < count;) {
+                const char* e = lineEnd(q, cuts[t + 1]);
+                if (!isBlankLine(q, e)) {
+                    if (!parseTraceLine(q, e, name, arrival, burst, priority, hasPriority)) {
+                        sliceError[t] = "malformed line for process " + to_string(row + 1);
+                        return;
+                    }
+                    if (arrival < 0 || burst < 1) {
+                        sliceError[t] = string(arrival < 0 ? "negative arrival time" : "burst time below 1")
+                                        + " for process " + to_string(row + 1);
+                        return;
+                    }
+                    table.arrivalTime[row] = arrival;
+                    table.processingTime[row] = burst;
+                    table.priority[row] = (readPriority && hasPriority) ? priority : (int)row;
+                    nameLength[row] = name.size();
+                    sliceNames[t].insert(sliceNames[t].end(), name.begin(), name.end());
+                    row++;
+                }
+                q = e + 1;
+            }
+        });
+    }
+    for (auto& th : threads) th.join();
+    threads.clear();
+    for (const string& e : sliceError) {
+        if (!e.empty()) {
+            error = e;
+            return false;
+        }
     }
     
-    static bool comparePriority(const Process& p1, const Process& p2) {
-        if (p1.priority != p2.priority)
-            return p1.priority < p2.priority; // Lower number = higher priority
-        return p1.arrivalTime < p2.arrivalTime;
+    uint64_t totalBytes = 0;
+    for (size_t i = 0; i < count; i++) {
+        table.names.offsets[i] = totalBytes;
+        totalBytes += nameLength[i];
+    }
+    if (totalBytes > UINT32_MAX) {
+        error = "process names exceed 4 GiB";
+        return false;
+    }
+    table.names.offsets[count] = totalBytes;
+    table.names.chars.resize(totalBytes);
+    for (unsigned t = 0; t < slices; t++) {
+        if (firstRow[t] >= count) break;
+        threads.emplace_back([&, t] {
+            memcpy(table.names.chars.data() + table.names.offsets[firstRow[t]],
+                   sliceNames[t].data(), sliceNames[t].size());
+        });
+    }
+    for (auto& th : threads) th.join();
+    return true;
+}
+
+inline bool loadBinaryTrace(const char* data, size_t size, bool readPriority,
+                            ProcessTable& table, string& error) {
+    BinaryTraceHeader header;
+    memcpy(&header, data, sizeof(header));
+    if (header.version != 1) {
+        error = "unsupported binary trace version " + to_string(header.version);
+        return false;
+    }
+    uint64_t n = header.count;
+    if (n >= UINT32_MAX || header.nameBytes > UINT32_MAX) {
+        error = "corrupt binary trace";
+        return false;
+    }
+    // With n and nameBytes below 2^32 no term can wrap; the names are
+    // compared against what is left rather than added to the total
+    uint64_t columns = sizeof(header) + n * 3 * sizeof(int32_t) + (n + 1) * sizeof(uint32_t);
+    if (size < columns || size - columns < header.nameBytes) {
+        error = "truncated binary trace";
+        return false;
     }
     
-    static bool compareSRTF(const Process& p1, const Process& p2) {
-        if (p1.remainingTime != p2.remainingTime)
-            return p1.remainingTime < p2.remainingTime;
-        return p1.arrivalTime < p2.arrivalTime;
+    table.resizeInput(n);
+    const char* p = data + sizeof(header);
+    memcpy(table.arrivalTime.data(), p, n * sizeof(int32_t));
+    p += n * sizeof(int32_t);
+    memcpy(table.processingTime.data(), p, n * sizeof(int32_t));
+    p += n * sizeof(int32_t);
+    for (uint64_t i = 0; i < n; i++) {
+        if (table.arrivalTime[i] < 0 || table.processingTime[i] < 1) {
+            error = string(table.arrivalTime[i] < 0 ? "negative arrival time" : "burst time below 1")
+                    + " for process " + to_string(i + 1);
+            return false;
+        }
+    }
+    if (readPriority && header.hasPriority) {
+        memcpy(table.priority.data(), p, n * sizeof(int32_t));
+    } else {
+        for (uint64_t i = 0; i < n; i++) table.priority[i] = i;
+    }
+    p += n * sizeof(int32_t);
+    memcpy(table.names.offsets.data(), p, (n + 1) * sizeof(uint32_t));
+    p += (n + 1) * sizeof(uint32_t);
+    const vector<uint32_t>& offsets = table.names.offsets;
+    bool offsetsOk = offsets[0] == 0 && offsets[n] == header.nameBytes;
+    for (uint64_t i = 0; offsetsOk && i < n; i++) offsetsOk = offsets[i] <= offsets[i + 1];
+    if (!offsetsOk) {
+        error = "corrupt binary trace";
+        return false;
     }
+    table.names.chars.assign(p, p + header.nameBytes);
+    return true;
+}
+
+inline bool writeBinaryTrace(const string& filename, const ProcessTable& table, bool hasPriority) {
+    ofstream out(filename, ios::binary);
+    if (!out) return false;
+    BinaryTraceHeader header;
+    memcpy(header.magic, BINARY_TRACE_MAGIC, sizeof(header.magic));
+    header.version = 1;
+    header.hasPriority = hasPriority;
+    header.count = table.size();
+    header.nameBytes = table.names.chars.size();
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(table.arrivalTime.data()), table.size() * sizeof(int32_t));
+    out.write(reinterpret_cast<const char*>(table.processingTime.data()), table.size() * sizeof(int32_t));
+    out.write(reinterpret_cast<const char*>(table.priority.data()), table.size() * sizeof(int32_t));
+    out.write(reinterpret_cast<const char*>(table.names.offsets.data()), table.names.offsets.size() * sizeof(uint32_t));
+    out.write(table.names.chars.data(), table.names.chars.size());
+    return (bool)out;
+}
+
+// Same layout parseTextTrace reads; the priority column only with hasPriority
+inline bool writeTextTrace(const string& filename, const ProcessTable& table, bool hasPriority) {
+    ofstream out(filename);
+    if (!out) return false;
+    string buffer = to_string(table.size()) + "\n";
+    char number[16];
+    auto field = [&](int v) {
+        buffer += ' ';
+        buffer.append(number, to_chars(number, number + sizeof(number), v).ptr);
+    };
+    for (uint32_t i = 0; i < table.size(); i++) {
+        buffer += table.names[i];
+        field(table.arrivalTime[i]);
+        field(table.processingTime[i]);
+        if (hasPriority) field(table.priority[i]);
+        buffer += '\n';
+        if (buffer.size() >= (1 << 20)) {
+            out.write(buffer.data(), buffer.size());
+            buffer.clear();
+        }
+    }
+    out.write(buffer.data(), buffer.size());
+    return (bool)out;
+}
+
+/*************************************************************************************
+ *  Workload generator
+ *  Seeded synthetic traces. Arrivals are a Poisson process, or Poisson
+ *  batches that share one instant; the rate is set so the offered CPU demand
+ *  per tick equals `load`. Bursts are exponential, Pareto (heavy tail) or a
+ *  bimodal mix of short and long exponential jobs, all with mean meanBurst.
+ ************************************************************************************/
+enum class ArrivalPattern { Poisson, Bursty };
+enum class BurstDistribution { Exponential, Pareto, Bimodal };
+enum class PriorityMix { Uniform, Skewed };
+
+struct WorkloadSpec {
+    size_t count = 1000;
+    uint64_t seed = 1;
+    double load = 0.9;
+    ArrivalPattern arrivals = ArrivalPattern::Poisson;
+    double batchSize = 8;         // bursty: mean number of arrivals per batch
+    BurstDistribution bursts = BurstDistribution::Exponential;
+    double meanBurst = 10;
+    double paretoShape = 1.5;     // tail index, > 1 for a finite mean
+    double longFraction = 0.1;    // bimodal: share of long jobs
+    double longRatio = 20;        // bimodal: long mean / short mean
+    PriorityMix priorities = PriorityMix::Uniform;
+    int priorityLevels = 10;      // skewed: each level half as common as the next lower one
 };
 
-class CPUScheduler {
+inline const char* describe(ArrivalPattern a) { return a == ArrivalPattern::Poisson ? "poisson" : "bursty"; }
+
+inline const char* describe(BurstDistribution b) {
+    switch (b) {
+        case BurstDistribution::Exponential: return "exponential";
+        case BurstDistribution::Pareto: return "pareto";
+        default: return "bimodal";
+    }
+}
+
+// Rows come out in arrival order and are named P0, P1, ...
+inline ProcessTable generateWorkload(const WorkloadSpec& spec) {
+    ProcessTable table;
+    table.reserve(spec.count);
+    mt19937_64 rng(spec.seed);
+    uniform_real_distribution<double> unit(0.0, 1.0);
+    
+    double rate = spec.load / spec.meanBurst;
+    double batchMean = spec.arrivals == ArrivalPattern::Bursty ? max(1.0, spec.batchSize) : 1.0;
+    exponential_distribution<double> gap(rate / batchMean);
+    geometric_distribution<long long> batchExtra(1.0 / batchMean);
+    
+    double shape = max(1.01, spec.paretoShape);
+    double paretoScale = spec.meanBurst * (shape - 1) / shape;
+    double shortMean = spec.meanBurst / (1 - spec.longFraction + spec.longFraction * spec.longRatio);
+    exponential_distribution<double> burstExp(1.0 / spec.meanBurst);
+    exponential_distribution<double> shortExp(1.0 / shortMean);
+    exponential_distribution<double> longExp(1.0 / (shortMean * spec.longRatio));
+    
+    int levels = max(1, spec.priorityLevels);
+    uniform_int_distribution<int> uniformLevel(0, levels - 1);
+    geometric_distribution<int> levelsUp(0.5);
+    
+    double clock = 0;
+    long long leftInBatch = 0;
+    char name[16] = {'P'};
+    for (size_t i = 0; i < spec.count; i++) {
+        if (leftInBatch == 0) {
+            clock += gap(rng);
+            leftInBatch = 1 + (batchMean > 1 ? batchExtra(rng) : 0);
+        }
+        leftInBatch--;
+        
+        double burst;
+        switch (spec.bursts) {
+            case BurstDistribution::Exponential: burst = burstExp(rng); break;
+            case BurstDistribution::Pareto: burst = paretoScale / pow(1.0 - unit(rng), 1.0 / shape); break;
+            default: burst = unit(rng) < spec.longFraction ? longExp(rng) : shortExp(rng); break;
+        }
+        
+        int prio = spec.priorities == PriorityMix::Uniform ? uniformLevel(rng)
+                                                           : levels - 1 - min(levels - 1, levelsUp(rng));
+        
+        char* nameEnd = to_chars(name + 1, name + sizeof(name), i).ptr;
+        table.add(string_view(name, nameEnd - name), (int)min<double>(clock, INT_MAX / 2),
+                  (int)clamp<double>(llround(burst), 1, 1e9), prio);
+    }
+    return table;
+}
+
+/*************************************************************************************
+ *  Thread pool
+ ************************************************************************************/
+class ThreadPool {
 private:
-    vector<Process> processes;
-    vector<string> executionOrder;
+    vector<thread> workers;
+    queue<function<void()>> tasks;
+    mutex mtx;
+    condition_variable taskReady;
+    condition_variable allDone;
+    size_t unfinished = 0;
+    bool stopping = false;
+    
+    void workerLoop() {
+        for (;;) {
+            function<void()> task;
+            {
+                unique_lock<mutex> lock(mtx);
+                taskReady.wait(lock, [this] { return stopping || !tasks.empty(); });
+                if (tasks.empty()) return;
+                task = move(tasks.front());
+                tasks.pop();
+            }
+            task();
+            lock_guard<mutex> lock(mtx);
+            if (--unfinished == 0) allDone.notify_all();
+        }
+    }
+
+public:
+    explicit ThreadPool(unsigned workerCount = thread::hardware_concurrency()) {
+        for (unsigned i = 0; i < max(1u, workerCount); i++)
+            workers.emplace_back([this] { workerLoop(); });
+    }
+    
+    ~ThreadPool() {
+        {
+            lock_guard<mutex> lock(mtx);
+            stopping = true;
+        }
+        taskReady.notify_all();
+        for (auto& t : workers) t.join();
+    }
     
-    void resetProcesses() {
-        for (auto& p : processes) {
-            p.remainingTime = p.processingTime;
-            p.responseTime = 0;
-            p.turnaround = 0;
-            p.delay = 0;
-            p.startTime = -1;
-            p.hasStarted = false;
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    
+    void submit(function<void()> task) {
+        {
+            lock_guard<mutex> lock(mtx);
+            tasks.push(move(task));
+            unfinished++;
         }
-        executionOrder.clear();
+        taskReady.notify_one();
+    }
+    
+    // Block until every submitted task has finished
+    void wait() {
+        unique_lock<mutex> lock(mtx);
+        allDone.wait(lock, [this] { return unfinished == 0; });
     }
+    
+    unsigned size() const { return workers.size(); }
+};
+
+// The command-line front end of cpusched::Simulator: trace files in,
+// out_*.txt reports out
+class CPUScheduler : public Simulator {
+private:
+    TraceFormat traceFormat = TraceFormat::Legacy;
+    bool perProcessOutput = true;  // out_*.txt files and execution traces
 
 public:
+    // Loads a text or binary trace (detected by its magic bytes). Without
+    // readPriority every process gets its input line as priority.
     void readInput(const string& filename, bool readPriority = false) {
-        ifstream file(filename);
-        if (!file) {
+        MappedFile file(filename);
+        if (!file.isOpen()) {
             cerr << "Error opening file: " << filename << endl;
             exit(1);
         }
         
-        int numProcesses;
-        file >> numProcesses;
-        file.ignore();
-        
-        string line, name;
-        int arrivalTime, processingTime, priority;
-        
-        for (int i = 0; i < numProcesses; i++) {
-            getline(file, line);
-            stringstream s_stream(line);
-            s_stream >> name >> arrivalTime >> processingTime;
-            
-            if (readPriority && s_stream >> priority) {
-                processes.emplace_back(name, arrivalTime, processingTime, priority);
-            } else {
-                processes.emplace_back(name, arrivalTime, processingTime, i);
-            }
+        string error;
+        bool binary = file.size() >= sizeof(BinaryTraceHeader) &&
+                      memcmp(file.data(), BINARY_TRACE_MAGIC, sizeof(BINARY_TRACE_MAGIC)) == 0;
+        bool ok = binary ? loadBinaryTrace(file.data(), file.size(), readPriority, processes, error)
+                         : parseTextTrace(file.data(), file.data() + file.size(), readPriority, processes, error);
+        if (!ok) {
+            cerr << "Error reading " << filename << ": " << error << endl;
+            exit(1);
         }
-        file.close();
+        // A binary trace may have been written without priorities
+        BinaryTraceHeader header;
+        if (binary) memcpy(&header, file.data(), sizeof(header));
+        priorityFromInput = readPriority && (!binary || header.hasPriority);
+        sortArrivals();
     }
     
-    // 1. FCFS (First Come First Serve)
-    void scheduleFCFS() {
-        resetProcesses();
-        vector<Process> processesCopy = processes;
-        vector<Process> finishedProcesses;
-        
-        sort(processesCopy.begin(), processesCopy.end(), Process::compareFCFS);
+    bool writeBinary(const string& filename) const {
+        return writeBinaryTrace(filename, processes, priorityFromInput);
+    }
+    
+    bool writeText(const string& filename) const {
+        return writeTextTrace(filename, processes, priorityFromInput);
+    }
+    
+    // Run a policy and write its out_*.txt file
+    void schedule(Policy policy, int timeQuantum = 2) const {
+        writeOutput(POLICY_OUTPUT_FILES[(int)policy], simulate(policy, timeQuantum));
+    }
+    
+    void scheduleFCFS() const { schedule(Policy::FCFS); }
+    void scheduleSJF() const { schedule(Policy::SJF); }
+    void scheduleLJF() const { schedule(Policy::LJF); }
+    void scheduleRoundRobin(int timeQuantum = 2) const { schedule(Policy::RoundRobin, timeQuantum); }
+    void schedulePriority() const { schedule(Policy::Priority); }
+    void scheduleSRTF() const { schedule(Policy::SRTF); }
+    void scheduleCFS() const { schedule(Policy::CFS); }
+    void schedulePriorityAging() const { schedule(Policy::PriorityAging); }
+    void scheduleMLFQ() const { schedule(Policy::MLFQ); }
+    
+    void writeOutput(const string& filename, const RunContext& run) const {
+        ofstream file(filename);
+        if (!file) {
+            cerr << "Error opening file: " << filename << endl;
+            exit(1);
+        }
         
-        int currentTime = 0;
+        for (uint32_t p : run.finishedProcesses) {
+            file << processes.names[p] << ": (response=" << run.responseTime[p]
+                << ", turnaround=" << run.turnaround[p]
+                << ", delay=" << run.delay[p] << ")\n";
+        }
         
-        for (auto& p : processesCopy) {
-            if (currentTime < p.arrivalTime) {
-                currentTime = p.arrivalTime;
+        if (traceFormat == TraceFormat::Segments) {
+            for (const auto& seg : run.executionOrder.get())
+                file << processes.names[seg.pid] << " " << seg.start << " " << seg.end << "\n";
+        } else {
+            for (const auto& seg : run.executionOrder.get()) {
+                string_view name = processes.names[seg.pid];
+                for (int i = 0; i < seg.slices; i++)
+                    file.write(name.data(), name.size());
             }
-            
-            p.responseTime = currentTime - p.arrivalTime;
-            p.startTime = currentTime;
-            currentTime += p.processingTime;
-            p.turnaround = currentTime - p.arrivalTime;
-            p.delay = p.turnaround - p.processingTime;
-            
-            executionOrder.push_back(p.name);
-            finishedProcesses.push_back(p);
+            file << endl;
         }
         
-        writeOutput("out_fcfs.txt", finishedProcesses);
+        file.close();
     }
     
-    // 2. SJF (Shortest Job First)
-    void scheduleSJF() {
-        resetProcesses();
-        vector<Process> processesCopy = processes;
-        vector<Process> readyQueue;
-        vector<Process> finishedProcesses;
-        int currentTime = 0;
+    void setTraceFormat(TraceFormat format) { traceFormat = format; }
+    void setPerProcessOutput(bool on) {
+        perProcessOutput = on;
+        setRecordTrace(on);
+    }
+    bool writesPerProcessOutput() const { return perProcessOutput; }
+    
+    // One block per policy: throughput and utilization over the span from the
+    // first arrival to the last completion, then the latency distributions
+    void writeStats(const string& filename, const vector<RunStats>& stats, int timeQuantum) const {
+        ofstream file(filename);
+        if (!file) {
+            cerr << "Error opening file: " << filename << endl;
+            exit(1);
+        }
         
-        while (!processesCopy.empty() || !readyQueue.empty()) {
-            for (auto it = processesCopy.begin(); it != processesCopy.end();) {
-                if (it->arrivalTime <= currentTime) {
-                    readyQueue.push_back(*it);
-                    it = processesCopy.erase(it);
-                } else {
-                    ++it;
-                }
-            }
-            
-            if (readyQueue.empty()) {
-                currentTime = processesCopy.front().arrivalTime;
-                continue;
-            }
-            
-            sort(readyQueue.begin(), readyQueue.end(), Process::compareSJF);
-            
-            Process p = readyQueue.front();
-            readyQueue.erase(readyQueue.begin());
-            
-            p.responseTime = max(0, currentTime - p.arrivalTime);
-            int endTime = currentTime + p.processingTime;
-            p.turnaround = endTime - p.arrivalTime;
-            p.delay = p.turnaround - p.processingTime;
-            currentTime = endTime;
+        file << fixed << setprecision(3);
+        for (int p = 0; p < POLICY_COUNT; p++) {
+            const RunStats& s = stats[p];
+            string params = describeParams((Policy)p, timeQuantum);
+            file << POLICY_NAMES[p] << (params.empty() ? "" : " (" + params + ")")
+                 << ": processes=" << s.turnaround.count() << " span=" << s.span()
+                 << " throughput=" << s.throughput() << "/tick"
+                 << " utilization=" << 100.0 * s.utilization() << "%\n";
             
-            executionOrder.push_back(p.name);
-            finishedProcesses.push_back(p);
+            auto line = [&file](const char* label, const LatencyHistogram& h) {
+                file << "  " << left << setw(11) << label << right
+                     << "mean=" << h.mean() << " p50=" << h.percentile(0.50)
+                     << " p90=" << h.percentile(0.90) << " p99=" << h.percentile(0.99)
+                     << " p99.9=" << h.percentile(0.999) << " max=" << h.highest() << "\n";
+            };
+            line("response", s.response);
+            line("turnaround", s.turnaround);
+            line("delay", s.delay);
         }
-        
-        writeOutput("out_sjf.txt", finishedProcesses);
     }
     
-    // 3. LJF (Longest Job First) 
-    void scheduleLJF() {
-        resetProcesses();
-        vector<Process> processesCopy = processes;
-        vector<Process> readyQueue;
-        vector<Process> finishedProcesses;
-        int currentTime = 0;
+    // Every policy gets its own RunContext over the shared table, so they are
+    // dispatched together on a thread per policy (as far as the cores allow)
+    // and the wall time is that of the slowest one. The aggregates of all of
+    // them go to out_stats.txt; with per-process output off that is the only
+    // file written.
+    void runAll(int timeQuantum = 2) const {
+        ThreadPool pool(min<unsigned>(POLICY_COUNT, max(1u, thread::hardware_concurrency())));
+        vector<RunStats> stats(POLICY_COUNT);
         
-        while (!processesCopy.empty() || !readyQueue.empty()) {
-            for (auto it = processesCopy.begin(); it != processesCopy.end();) {
-                if (it->arrivalTime <= currentTime) {
-                    readyQueue.push_back(*it);
-                    it = processesCopy.erase(it);
-                } else {
-                    ++it;
-                }
-            }
-            
-            if (readyQueue.empty()) {
-                currentTime = processesCopy.front().arrivalTime;
-                continue;
-            }
-            
-            sort(readyQueue.begin(), readyQueue.end(), Process::compareLJF);
-            
-            Process p = readyQueue.front();
-            readyQueue.erase(readyQueue.begin());
-            
-            p.responseTime = max(0, currentTime - p.arrivalTime);
-            int endTime = currentTime + p.processingTime;
-            p.turnaround = endTime - p.arrivalTime;
-            p.delay = p.turnaround - p.processingTime;
-            currentTime = endTime;
-            
-            executionOrder.push_back(p.name);
-            finishedProcesses.push_back(p);
-        }
+        auto submit = [&](Policy policy) {
+            pool.submit([this, policy, timeQuantum, &stats] {
+                RunContext run = simulate(policy, timeQuantum);
+                if (perProcessOutput) writeOutput(POLICY_OUTPUT_FILES[(int)policy], run);
+                stats[(int)policy] = run.stats;
+            });
+        };
         
-        writeOutput("out_ljf.txt", finishedProcesses);
+        cout << "Running FCFS..." << endl;
+        submit(Policy::FCFS);
+        
+        cout << "Running SJF..." << endl;
+        submit(Policy::SJF);
+        
+        cout << "Running LJF..." << endl;
+        submit(Policy::LJF);
+        
+        cout << "Running Round Robin (quantum=" << timeQuantum << ")..." << endl;
+        submit(Policy::RoundRobin);
+        
+        cout << "Running Priority..." << endl;
+        submit(Policy::Priority);
+        
+        cout << "Running SRTF..." << endl;
+        submit(Policy::SRTF);
+        
+        cout << "Running CFS (latency=" << cfs.targetLatency << ", granularity=" << cfs.minGranularity << ")..." << endl;
+        submit(Policy::CFS);
+        
+        cout << "Running Priority with aging (interval=" << aging.interval << ")..." << endl;
+        submit(Policy::PriorityAging);
+        
+        cout << "Running MLFQ (" << describeParams(Policy::MLFQ, timeQuantum) << ")..." << endl;
+        submit(Policy::MLFQ);
+        
+        pool.wait();
+        writeStats("out_stats.txt", stats, timeQuantum);
+        cout << "All scheduling algorithms completed!" << endl;
     }
+};
+
+/*************************************************************************************
+ *  SMP simulation
+ *  Runs a policy on N simulated CPUs, each with its own ready queue. Arrivals
+ *  are dealt round-robin over the CPUs, or to the least loaded one with push
+ *  balancing. Idle CPUs can pull from the busiest queue or steal from a random
+ *  victim, and a process that has already run pays migrationCost extra CPU
+ *  time whenever it changes CPU. Event driven: a CPU only does work when its
+ *  slice ends, something arrives or a balance tick fires.
+ ************************************************************************************/
+struct SmpConfig {
+    unsigned cpus = 4;
+    bool push = false;         // least-loaded placement plus a rebalance every balanceInterval
+    bool pull = false;         // an idle CPU pulls one process from the busiest queue
+    bool steal = false;        // an idle CPU steals half the queue of a random victim
+    int migrationCost = 0;
+    int balanceInterval = 10;
+    int timeQuantum = 2;
+    uint64_t seed = 1;
+};
+
+struct CpuMetrics {
+    long long busyTime = 0;
+    size_t dispatches = 0;
+    size_t completed = 0;
+    size_t migrationsIn = 0;
+};
+
+struct SmpResult {
+    Policy policy;
+    RunContext run;
+    vector<CpuMetrics> cpus;
+    int makespan = 0;
+};
+
+// Per-CPU ready queue: a FIFO for Round Robin, otherwise a binary min-heap on
+// (key, arrival, row). Both give up their last element in O(1) for
+// migration: the youngest FIFO entry or a heap leaf.
+class CpuQueue {
+public:
+    struct Entry {
+        long long key;
+        int arrival;
+        uint32_t pid;
+        
+        bool operator<(const Entry& o) const {
+            if (key != o.key) return key < o.key;
+            if (arrival != o.arrival) return arrival < o.arrival;
+            return pid < o.pid;
+        }
+    };
+
+private:
+    bool fifo;
+    deque<Entry> fifoQueue;
+    vector<Entry> heap;
+    
+    static bool runsAfter(const Entry& a, const Entry& b) { return b < a; }
+
+public:
+    explicit CpuQueue(bool fifo = false) : fifo(fifo) {}
     
-    // 4. Round Robin
-    void scheduleRoundRobin(int timeQuantum = 2) {
-        resetProcesses();
-        vector<Process> processesCopy = processes;
-        queue<Process*> readyQueue;
-        vector<Process> finishedProcesses;
-        int currentTime = 0;
-        int processIndex = 0;
+    // The entry of row p under `policy`, shared by the SMP simulation and the
+    // executor so both order their queues alike. Only SRTF looks at the
+    // remaining time; FCFS and RR keep arrival order.
+    static Entry entryFor(Policy policy, const ProcessTable& processes, uint32_t p, int remaining) {
+        long long key = 0;
+        switch (policy) {
+            case Policy::SJF: key = processes.processingTime[p]; break;
+            case Policy::LJF: key = -(long long)processes.processingTime[p]; break;
+            case Policy::Priority: key = processes.priority[p]; break;
+            case Policy::SRTF: key = remaining; break;
+            default: break;
+        }
+        return {key, processes.arrivalTime[p], p};
+    }
+    
+    size_t size() const { return fifo ? fifoQueue.size() : heap.size(); }
+    bool empty() const { return size() == 0; }
+    
+    const Entry& top() const { return fifo ? fifoQueue.front() : heap.front(); }
+    
+    void push(const Entry& e) {
+        if (fifo) {
+            fifoQueue.push_back(e);
+        } else {
+            heap.push_back(e);
+            push_heap(heap.begin(), heap.end(), runsAfter);
+        }
+    }
+    
+    uint32_t pop() {
+        uint32_t pid;
+        if (fifo) {
+            pid = fifoQueue.front().pid;
+            fifoQueue.pop_front();
+        } else {
+            pop_heap(heap.begin(), heap.end(), runsAfter);
+            pid = heap.back().pid;
+            heap.pop_back();
+        }
+        return pid;
+    }
+    
+    uint32_t popBack() {
+        uint32_t pid;
+        if (fifo) {
+            pid = fifoQueue.back().pid;
+            fifoQueue.pop_back();
+        } else {
+            pid = heap.back().pid;
+            heap.pop_back();
+        }
+        return pid;
+    }
+};
+
+class SmpSimulation {
+private:
+    static constexpr uint32_t NONE = UINT32_MAX;
+    
+    struct Cpu {
+        uint32_t running = NONE;
+        uint32_t requeueing = 0;  // stopped this instant, not yet back in the queue
+        int sliceStart = 0;
+        uint32_t version = 0;  // bumped whenever the running slice ends early
+    };
+    
+    struct CpuEvent {
+        int time;
+        uint32_t cpu;
+        uint32_t version;
         
-        sort(processesCopy.begin(), processesCopy.end(), Process::compareFCFS);
+        bool operator>(const CpuEvent& o) const {
+            return time != o.time ? time > o.time : cpu > o.cpu;
+        }
+    };
+    
+    const ProcessTable& processes;
+    const vector<uint32_t>& arrivals;
+    Policy policy;
+    SmpConfig config;
+    SmpResult result;
+    RunContext& run;
+    vector<Cpu> cpus;
+    vector<CpuQueue> queues;
+    priority_queue<CpuEvent, vector<CpuEvent>, greater<CpuEvent>> events;
+    vector<uint32_t> dirty;  // CPUs whose queue or slice changed at this instant
+    vector<char> isDirty;
+    size_t queued = 0;
+    uint64_t rng;
+    int now = 0;
+    
+    void markDirty(uint32_t c) {
+        if (!isDirty[c]) {
+            isDirty[c] = 1;
+            dirty.push_back(c);
+        }
+    }
+    
+    void enqueue(uint32_t c, uint32_t p) {
+        queues[c].push(CpuQueue::entryFor(policy, processes, p, run.remainingTime[p]));
+        queued++;
+        markDirty(c);
+    }
+    
+    size_t load(uint32_t c) const {
+        return queues[c].size() + (cpus[c].running != NONE) + cpus[c].requeueing;
+    }
+    
+    uint32_t place(size_t arrivalIndex) const {
+        if (!config.push) return arrivalIndex % cpus.size();
+        uint32_t best = 0;
+        for (uint32_t c = 1; c < cpus.size(); c++)
+            if (load(c) < load(best)) best = c;
+        return best;
+    }
+    
+    void migrate(uint32_t from, uint32_t to) {
+        uint32_t p = queues[from].popBack();
+        queued--;
+        if (run.hasStarted[p]) run.remainingTime[p] += config.migrationCost;
+        result.cpus[to].migrationsIn++;
+        enqueue(to, p);
+    }
+    
+    // Ends the running slice at `now`; returns the process if it has work left
+    uint32_t stop(uint32_t c) {
+        Cpu& cpu = cpus[c];
+        uint32_t p = cpu.running;
+        int ran = now - cpu.sliceStart;
+        run.remainingTime[p] -= ran;
+        result.cpus[c].busyTime += ran;
+        cpu.running = NONE;
+        cpu.version++;
+        markDirty(c);
+        if (run.remainingTime[p] > 0) return p;
+        run.finish(p, now);
+        result.cpus[c].completed++;
+        return NONE;
+    }
+    
+    void dispatch(uint32_t c) {
+        Cpu& cpu = cpus[c];
+        uint32_t p = queues[c].pop();
+        queued--;
+        if (!run.hasStarted[p]) {
+            run.responseTime[p] = now - processes.arrivalTime[p];
+            run.hasStarted[p] = 1;
+        }
+        int slice = run.remainingTime[p];
+        if (policy == Policy::RoundRobin) slice = min(slice, config.timeQuantum);
+        cpu.running = p;
+        cpu.sliceStart = now;
+        events.push({now + slice, c, cpu.version});
+        result.cpus[c].dispatches++;
+    }
+    
+    // SRTF: does the head of c's queue beat the process running on c?
+    bool shouldPreempt(uint32_t c) const {
+        if (policy != Policy::SRTF || cpus[c].running == NONE || queues[c].empty()) return false;
+        uint32_t p = cpus[c].running;
+        CpuQueue::Entry current = {run.remainingTime[p] - (now - cpus[c].sliceStart), processes.arrivalTime[p], p};
+        return queues[c].top() < current;
+    }
+    
+    void dispatchDirty() {
+        for (uint32_t c : dirty) {
+            if (shouldPreempt(c)) enqueue(c, stop(c));
+            if (cpus[c].running == NONE && !queues[c].empty()) dispatch(c);
+        }
+        for (uint32_t c : dirty) isDirty[c] = 0;
+        dirty.clear();
+    }
+    
+    void pushBalance() {
+        uint32_t busiest = 0, idlest = 0;
+        for (uint32_t c = 1; c < cpus.size(); c++) {
+            if (load(c) > load(busiest)) busiest = c;
+            if (load(c) < load(idlest)) idlest = c;
+        }
+        while (load(busiest) > load(idlest) + 1 && !queues[busiest].empty())
+            migrate(busiest, idlest);
+    }
+    
+    bool pull(uint32_t c) {
+        uint32_t busiest = c;
+        for (uint32_t v = 0; v < cpus.size(); v++)
+            if (queues[v].size() > queues[busiest].size()) busiest = v;
+        if (busiest == c) return false;
+        migrate(busiest, c);
+        return true;
+    }
+    
+    bool steal(uint32_t c) {
+        for (int probe = 0; probe < 4; probe++) {
+            rng ^= rng << 13;
+            rng ^= rng >> 7;
+            rng ^= rng << 17;
+            uint32_t victim = rng % cpus.size();
+            if (victim == c || queues[victim].empty()) continue;
+            size_t take = (queues[victim].size() + 1) / 2;
+            for (size_t i = 0; i < take; i++) migrate(victim, c);
+            return true;
+        }
+        return false;
+    }
+
+public:
+    SmpSimulation(const ProcessTable& table, const vector<uint32_t>& arrivalOrder, Policy policy, const SmpConfig& config)
+        : processes(table), arrivals(arrivalOrder), policy(policy), config(config),
+          result{policy, RunContext(table), vector<CpuMetrics>(max(1u, config.cpus)), 0}, run(result.run),
+          cpus(max(1u, config.cpus)), queues(cpus.size(), CpuQueue(policy == Policy::RoundRobin)),
+          isDirty(cpus.size(), 0), rng(config.seed | 1) {
+        this->config.balanceInterval = max(1, config.balanceInterval);
+    }
+    
+    SmpResult simulate() {
+        size_t n = arrivals.size(), cursor = 0;
+        int nextBalance = config.balanceInterval;
+        vector<pair<uint32_t, uint32_t>> requeue;  // (cpu, process)
         
-        while (!processesCopy.empty() || !readyQueue.empty()) {
-            // Add newly arrived processes
-            while (processIndex < processesCopy.size() && 
-                   processesCopy[processIndex].arrivalTime <= currentTime) {
-                readyQueue.push(&processesCopy[processIndex]);
-                processIndex++;
+        while (run.finishedProcesses.size() < n) {
+            int t = INT_MAX;
+            if (cursor < n) t = processes.arrivalTime[arrivals[cursor]];
+            if (!events.empty()) t = min(t, events.top().time);
+            bool balance = config.push && cpus.size() > 1 && queued > 0;
+            if (balance) {
+                if (nextBalance <= now) nextBalance = (now / config.balanceInterval + 1) * config.balanceInterval;
+                t = min(t, nextBalance);
             }
+            now = t;
             
-            if (readyQueue.empty()) {
-                if (processIndex < processesCopy.size()) {
-                    currentTime = processesCopy[processIndex].arrivalTime;
+            while (!events.empty() && events.top().time == now) {
+                CpuEvent e = events.top();
+                events.pop();
+                if (e.version != cpus[e.cpu].version) continue;
+                uint32_t p = stop(e.cpu);
+                if (p != NONE) {
+                    requeue.push_back({e.cpu, p});
+                    cpus[e.cpu].requeueing++;
                 }
-                continue;
             }
             
-            Process* p = readyQueue.front();
-            readyQueue.pop();
-            
-            if (!p->hasStarted) {
-                p->responseTime = currentTime - p->arrivalTime;
-                p->startTime = currentTime;
-                p->hasStarted = true;
+            // Arrivals go in before the processes whose slice just ended,
+            // as in the single-CPU Round Robin
+            while (cursor < n && processes.arrivalTime[arrivals[cursor]] == now) {
+                enqueue(place(cursor), arrivals[cursor]);
+                cursor++;
             }
+            for (auto [c, p] : requeue) {
+                cpus[c].requeueing--;
+                enqueue(c, p);
+            }
+            requeue.clear();
             
-            int execTime = min(timeQuantum, p->remainingTime);
-            currentTime += execTime;
-            p->remainingTime -= execTime;
-            
-            executionOrder.push_back(p->name);
-            
-            // Add newly arrived processes before re-queueing current process
-            while (processIndex < processesCopy.size() && 
-                   processesCopy[processIndex].arrivalTime <= currentTime) {
-                readyQueue.push(&processesCopy[processIndex]);
-                processIndex++;
+            if (balance && now == nextBalance) {
+                pushBalance();
+                nextBalance += config.balanceInterval;
             }
             
-            if (p->remainingTime > 0) {
-                readyQueue.push(p);
-            } else {
-                p->turnaround = currentTime - p->arrivalTime;
-                p->delay = p->turnaround - p->processingTime;
-                finishedProcesses.push_back(*p);
+            // CPUs first take their own work; only those still idle then
+            // pull or steal, so nothing bounces between CPUs within an instant
+            dispatchDirty();
+            if ((config.pull || config.steal) && queued > 0) {
+                for (uint32_t c = 0; c < cpus.size() && queued > 0; c++) {
+                    if (cpus[c].running != NONE) continue;
+                    if (!(config.pull && pull(c)) && config.steal) steal(c);
+                }
+                dispatchDirty();
             }
         }
         
-        writeOutput("out_rr.txt", finishedProcesses);
+        result.makespan = now;
+        return move(result);
+    }
+};
+
+inline void writeSmpReport(const string& filename, const SmpConfig& config, const vector<SmpResult>& results) {
+    ofstream file(filename);
+    if (!file) {
+        cerr << "Error opening file: " << filename << endl;
+        exit(1);
     }
     
-    // 5. Priority Scheduling (Non-preemptive)
-    void schedulePriority() {
-        resetProcesses();
-        vector<Process> processesCopy = processes;
-        vector<Process> readyQueue;
-        vector<Process> finishedProcesses;
-        int currentTime = 0;
-        
-        while (!processesCopy.empty() || !readyQueue.empty()) {
-            for (auto it = processesCopy.begin(); it != processesCopy.end();) {
-                if (it->arrivalTime <= currentTime) {
-                    readyQueue.push_back(*it);
-                    it = processesCopy.erase(it);
-                } else {
-                    ++it;
-                }
-            }
-            
-            if (readyQueue.empty()) {
-                currentTime = processesCopy.front().arrivalTime;
-                continue;
-            }
-            
-            sort(readyQueue.begin(), readyQueue.end(), Process::comparePriority);
-            
-            Process p = readyQueue.front();
-            readyQueue.erase(readyQueue.begin());
-            
-            p.responseTime = max(0, currentTime - p.arrivalTime);
-            int endTime = currentTime + p.processingTime;
-            p.turnaround = endTime - p.arrivalTime;
-            p.delay = p.turnaround - p.processingTime;
-            currentTime = endTime;
-            
-            executionOrder.push_back(p.name);
-            finishedProcesses.push_back(p);
+    string balance;
+    if (config.push) balance += "push ";
+    if (config.pull) balance += "pull ";
+    if (config.steal) balance += "steal ";
+    if (balance.empty()) balance = "none ";
+    file << "SMP: " << config.cpus << " CPUs, balance: " << balance << "(interval=" << config.balanceInterval
+         << "), migration cost=" << config.migrationCost << ", quantum=" << config.timeQuantum << "\n";
+    file << fixed << setprecision(3);
+    
+    for (const SmpResult& r : results) {
+        const RunContext& run = r.run;
+        size_t n = run.finishedProcesses.size();
+        // Percentiles come from the run's histograms, as in out_stats.txt
+        const LatencyHistogram& response = run.stats.response;
+        const LatencyHistogram& turnaround = run.stats.turnaround;
+        long long totalResponse = 0, totalTurnaround = 0, totalDelay = 0, busy = 0;
+        int maxDelay = 0;
+        size_t migrations = 0;
+        for (size_t i = 0; i < n; i++) {
+            totalResponse += run.responseTime[i];
+            totalTurnaround += run.turnaround[i];
+            totalDelay += run.delay[i];
+            maxDelay = max(maxDelay, run.delay[i]);
         }
+        for (const CpuMetrics& m : r.cpus) {
+            busy += m.busyTime;
+            migrations += m.migrationsIn;
+        }
+        double count = max<size_t>(1, n);
+        double span = max(1, r.makespan);
         
-        writeOutput("out_priority.txt", finishedProcesses);
+        file << "\n" << POLICY_NAMES[(int)r.policy] << ": processes=" << n << " makespan=" << r.makespan
+             << " utilization=" << 100.0 * busy / (span * r.cpus.size()) << "% migrations=" << migrations << "\n";
+        file << "  response: avg=" << totalResponse / count << " p50=" << response.percentile(0.50)
+             << " p99=" << response.percentile(0.99) << " p99.9=" << response.percentile(0.999) << "\n";
+        file << "  turnaround: avg=" << totalTurnaround / count << " p50=" << turnaround.percentile(0.50)
+             << " p99=" << turnaround.percentile(0.99) << " p99.9=" << turnaround.percentile(0.999) << "\n";
+        file << "  delay: avg=" << totalDelay / count << " max=" << maxDelay << "\n";
+        for (size_t c = 0; c < r.cpus.size(); c++) {
+            const CpuMetrics& m = r.cpus[c];
+            file << "  cpu " << c << ": busy=" << m.busyTime << " utilization=" << 100.0 * m.busyTime / span
+                 << "% dispatches=" << m.dispatches << " completed=" << m.completed
+                 << " migrations_in=" << m.migrationsIn << "\n";
+        }
+    }
+}
+
+// The SMP model covers the first six policies; CFS runs on a single CPU only
+const int SMP_POLICY_COUNT = 6;
+
+// All SMP policies side by side, reported to out_smp.txt
+inline void runSmp(const CPUScheduler& scheduler, const SmpConfig& config) {
+    cout << "Running SMP simulation on " << config.cpus << " CPUs..." << endl;
+    ThreadPool pool(min<unsigned>(SMP_POLICY_COUNT, max(1u, thread::hardware_concurrency())));
+    vector<unique_ptr<SmpResult>> results(SMP_POLICY_COUNT);
+    for (int p = 0; p < SMP_POLICY_COUNT; p++) {
+        pool.submit([&, p] {
+            SmpSimulation simulation(scheduler.table(), scheduler.arrivalOrder(), (Policy)p, config);
+            results[p] = make_unique<SmpResult>(simulation.simulate());
+        });
     }
+    pool.wait();
     
-    // 6. SRTF (Shortest Remaining Time First - Preemptive SJF)
-    void scheduleSRTF() {
-        resetProcesses();
-        vector<Process> processesCopy = processes;
-        vector<Process> finishedProcesses;
-        int currentTime = 0;
-        int completed = 0;
-        int n = processesCopy.size();
-        
-        while (completed < n) {
-            int idx = -1;
-            int minRemaining = INT_MAX;
-            
-            // Find process with shortest remaining time
-            for (int i = 0; i < n; i++) {
-                if (processesCopy[i].arrivalTime <= currentTime && 
-                    processesCopy[i].remainingTime > 0) {
-                    if (processesCopy[i].remainingTime < minRemaining) {
-                        minRemaining = processesCopy[i].remainingTime;
-                        idx = i;
-                    } else if (processesCopy[i].remainingTime == minRemaining) {
-                        if (processesCopy[i].arrivalTime < processesCopy[idx].arrivalTime) {
-                            idx = i;
-                        }
-                    }
-                }
-            }
+    vector<SmpResult> ordered;
+    for (auto& r : results) ordered.push_back(move(*r));
+    writeSmpReport("out_smp.txt", config, ordered);
+    cout << "SMP report written to out_smp.txt" << endl;
+}
+
+/*************************************************************************************
+ *  Real execution
+ *  Runs the workload for real instead of on paper. Each process becomes a
+ *  CPU-bound task of `burst` work units of about tickMicros each, submitted
+ *  at arrival * tickMicros after the start. A pool of worker threads shares
+ *  one ready queue ordered as in the SMP model. Tasks yield after every unit:
+ *  Round Robin ends a slice there, and SRTF preempts there when a shorter
+ *  task has arrived. Response and turnaround are measured with steady_clock
+ *  from the nominal submission time and reported in ticks, next to the
+ *  simulated figures for the same policy.
+ ************************************************************************************/
+struct ExecConfig {
+    unsigned workers = 1;
+    int tickMicros = 1000;
+    int timeQuantum = 2;
+};
+
+// xorshift rounds: real ALU work. Results end up in spinSink so the
+// compiler cannot drop the loop.
+inline atomic<uint64_t> spinSink{0};
+
+inline uint64_t spinWork(uint64_t iterations, uint64_t x) {
+    for (uint64_t i = 0; i < iterations; i++) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+    }
+    return x;
+}
+
+// spinWork iterations that take about one microsecond on this host
+inline uint64_t calibrateSpin() {
+    uint64_t x = 1;
+    for (uint64_t iterations = 1 << 16;; iterations *= 2) {
+        auto start = chrono::steady_clock::now();
+        x = spinWork(iterations, x | 1);
+        double micros = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count();
+        if (micros >= 20000) {
+            spinSink.fetch_xor(x, memory_order_relaxed);
+            return max<uint64_t>(1, (uint64_t)(iterations / micros));
+        }
+    }
+}
+
+struct ExecResult {
+    Policy policy;
+    vector<long long> responseMicros;
+    vector<long long> turnaroundMicros;
+    vector<uint32_t> finishedProcesses;
+    LatencyHistogram response;     // microseconds
+    LatencyHistogram turnaround;
+    size_t dispatches = 0;
+    size_t preemptions = 0;        // slices cut short at a yield point (SRTF)
+    double wallSeconds = 0;
+    RunContext simulated;
+};
+
+class Executor {
+private:
+    using Clock = chrono::steady_clock;
+    
+    const ProcessTable& processes;
+    const vector<uint32_t>& arrivals;
+    Policy policy;
+    ExecConfig config;
+    uint64_t spinPerUnit;
+    
+    mutex lock;
+    condition_variable wake;
+    CpuQueue queue;
+    vector<int> remaining;
+    vector<char> started;
+    size_t finished = 0;
+    atomic<uint64_t> releases{0};  // bumped on every submission; SRTF polls it at yield points
+    Clock::time_point origin;
+    ExecResult& result;
+    
+    Clock::time_point submitted(uint32_t p) const {
+        return origin + chrono::microseconds((long long)processes.arrivalTime[p] * config.tickMicros);
+    }
+    
+    long long microsSinceSubmit(uint32_t p, Clock::time_point t) const {
+        return chrono::duration_cast<chrono::microseconds>(t - submitted(p)).count();
+    }
+    
+    void worker() {
+        unique_lock<mutex> guard(lock);
+        uint64_t x = 88172645463325252ull;
+        for (;;) {
+            wake.wait(guard, [this] { return !queue.empty() || finished == processes.size(); });
+            if (queue.empty()) break;
             
-            if (idx == -1) {
-                currentTime++;
-                continue;
+            uint32_t p = queue.pop();
+            if (!started[p]) {
+                started[p] = 1;
+                result.responseMicros[p] = microsSinceSubmit(p, Clock::now());
             }
+            result.dispatches++;
+            int budget = policy == Policy::RoundRobin ? min(remaining[p], config.timeQuantum) : remaining[p];
+            uint64_t seen = releases.load();
+            guard.unlock();
             
-            Process& p = processesCopy[idx];
-            
-            if (!p.hasStarted) {
-                p.responseTime = currentTime - p.arrivalTime;
-                p.hasStarted = true;
+            int done = 0;
+            bool preempted = false;
+            while (done < budget && !preempted) {
+                x = spinWork(spinPerUnit, x);
+                done++;
+                // Yield point: a new arrival may have made a shorter task ready
+                if (policy == Policy::SRTF && done < budget && releases.load(memory_order_relaxed) != seen) {
+                    lock_guard<mutex> check(lock);
+                    seen = releases.load();
+                    preempted = !queue.empty() && queue.top().key < remaining[p] - done;
+                }
             }
             
-            p.remainingTime--;
-            currentTime++;
-            executionOrder.push_back(p.name);
-            
-            if (p.remainingTime == 0) {
-                completed++;
-                p.turnaround = currentTime - p.arrivalTime;
-                p.delay = p.turnaround - p.processingTime;
-                finishedProcesses.push_back(p);
+            guard.lock();
+            remaining[p] -= done;
+            if (remaining[p] > 0) {
+                if (preempted) result.preemptions++;
+                queue.push(CpuQueue::entryFor(policy, processes, p, remaining[p]));
+                wake.notify_one();
+            } else {
+                result.turnaroundMicros[p] = microsSinceSubmit(p, Clock::now());
+                result.finishedProcesses.push_back(p);
+                if (++finished == processes.size()) wake.notify_all();
             }
         }
-        
-        writeOutput("out_srtf.txt", finishedProcesses);
+        spinSink.fetch_xor(x, memory_order_relaxed);
+    }
+
+public:
+    Executor(const ProcessTable& table, const vector<uint32_t>& arrivalOrder, Policy policy,
+             const ExecConfig& config, uint64_t spinPerUnit, ExecResult& result)
+        : processes(table), arrivals(arrivalOrder), policy(policy), config(config),
+          spinPerUnit(spinPerUnit * config.tickMicros), queue(policy == Policy::RoundRobin),
+          remaining(table.processingTime), started(table.size(), 0), result(result) {
+        result.responseMicros.assign(table.size(), 0);
+        result.turnaroundMicros.assign(table.size(), 0);
+        result.finishedProcesses.reserve(table.size());
     }
     
-    void writeOutput(const string& filename, const vector<Process>& finishedProcesses) {
-        ofstream file(filename);
-        if (!file) {
-            cerr << "Error opening file: " << filename << endl;
-            exit(1);
-        }
+    void execute() {
+        origin = Clock::now();
+        vector<thread> workers;
+        for (unsigned w = 0; w < max(1u, config.workers); w++)
+            workers.emplace_back([this] { worker(); });
         
-        for (const auto& p : finishedProcesses) {
-            file << p.name << ": (response=" << p.responseTime
-                << ", turnaround=" << p.turnaround
-                << ", delay=" << p.delay << ")\n";
+        // Submit every process at its arrival time, all of one instant together
+        for (size_t i = 0; i < arrivals.size();) {
+            int t = processes.arrivalTime[arrivals[i]];
+            this_thread::sleep_until(submitted(arrivals[i]));
+            lock_guard<mutex> guard(lock);
+            for (; i < arrivals.size() && processes.arrivalTime[arrivals[i]] == t; i++)
+                queue.push(CpuQueue::entryFor(policy, processes, arrivals[i], remaining[arrivals[i]]));
+            releases++;
+            wake.notify_all();
         }
         
-        for (const auto& name : executionOrder)
-            file << name;
-        file << endl;
-        
-        file.close();
+        for (thread& w : workers) w.join();
+        result.wallSeconds = chrono::duration<double>(Clock::now() - origin).count();
+        for (uint32_t p : result.finishedProcesses) {
+            result.response.record(result.responseMicros[p]);
+            result.turnaround.record(result.turnaroundMicros[p]);
+        }
+    }
+};
+
+inline void writeExecReport(const string& filename, const ProcessTable& processes, const ExecConfig& config,
+                            const vector<unique_ptr<ExecResult>>& results, bool perProcess) {
+    ofstream file(filename);
+    if (!file) {
+        cerr << "Error opening file: " << filename << endl;
+        exit(1);
     }
     
-    void runAll(int timeQuantum = 2) {
-        cout << "Running FCFS..." << endl;
-        scheduleFCFS();
-        
-        cout << "Running SJF..." << endl;
-        scheduleSJF();
+    double tick = config.tickMicros;
+    file << "Real execution: " << config.workers << " worker(s), tick=" << config.tickMicros
+         << "us, quantum=" << config.timeQuantum << ", " << processes.size() << " processes\n";
+    file << fixed << setprecision(3);
+    for (const auto& r : results) {
+        const RunStats& sim = r->simulated.stats;
+        file << POLICY_NAMES[(int)r->policy] << ": wall=" << r->wallSeconds << "s, dispatches="
+             << r->dispatches << ", preemptions=" << r->preemptions << "\n";
+        auto line = [&](const char* label, const LatencyHistogram& measured, const LatencyHistogram& simulated) {
+            file << "  " << left << setw(11) << label << right
+                 << "simulated mean=" << simulated.mean() << " p99=" << simulated.percentile(0.99)
+                 << " | measured mean=" << measured.mean() / tick << " p50=" << measured.percentile(0.50) / tick
+                 << " p99=" << measured.percentile(0.99) / tick << " max=" << measured.highest() / tick << "\n";
+        };
+        line("response", r->response, sim.response);
+        line("turnaround", r->turnaround, sim.turnaround);
         
-        cout << "Running LJF..." << endl;
-        scheduleLJF();
-        
-        cout << "Running Round Robin (quantum=" << timeQuantum << ")..." << endl;
-        scheduleRoundRobin(timeQuantum);
-        
-        cout << "Running Priority..." << endl;
-        schedulePriority();
-        
-        cout << "Running SRTF..." << endl;
-        scheduleSRTF();
-        
-        cout << "All scheduling algorithms completed!" << endl;
+        if (!perProcess) continue;
+        for (uint32_t p : r->finishedProcesses) {
+            double turnaround = r->turnaroundMicros[p] / tick;
+            file << "  " << processes.names[p] << ": (response=" << r->responseMicros[p] / tick
+                 << ", turnaround=" << turnaround << ", delay=" << turnaround - processes.processingTime[p]
+                 << ") simulated (response=" << r->simulated.responseTime[p] << ", turnaround="
+                 << r->simulated.turnaround[p] << ", delay=" << r->simulated.delay[p] << ")\n";
+        }
+    }
+}
+
+// Executes the SMP policy set one policy at a time, so runs do not compete
+// for cores, and writes out_exec.txt. The simulated reference is the
+// single-CPU run for one worker and the SMP model with pull balancing (the
+// nearest model of a shared queue) for several.
+inline void runExecution(const CPUScheduler& scheduler, const ExecConfig& config) {
+    cout << "Calibrating work units..." << endl;
+    uint64_t spinPerMicro = calibrateSpin();
+    
+    vector<unique_ptr<ExecResult>> results;
+    for (int p = 0; p < SMP_POLICY_COUNT; p++) {
+        Policy policy = (Policy)p;
+        cout << "Executing " << POLICY_NAMES[p] << " on " << config.workers << " worker(s)..." << endl;
+        auto simulate = [&]() -> RunContext {
+            if (config.workers == 1) return scheduler.simulate(policy, config.timeQuantum);
+            SmpConfig smp;
+            smp.cpus = config.workers;
+            smp.pull = true;
+            smp.timeQuantum = config.timeQuantum;
+            return move(SmpSimulation(scheduler.table(), scheduler.arrivalOrder(), policy, smp).simulate().run);
+        };
+        results.push_back(make_unique<ExecResult>(ExecResult{policy, {}, {}, {}, {}, {}, 0, 0, 0, simulate()}));
+        Executor(scheduler.table(), scheduler.arrivalOrder(), policy, config, spinPerMicro, *results.back()).execute();
     }
+    
+    writeExecReport("out_exec.txt", scheduler.table(), config, results, scheduler.writesPerProcessOutput());
+    cout << "Execution report written to out_exec.txt" << endl;
+}
+
+/*************************************************************************************
+ *  Parameter sweep
+ *  Runs every policy over a list of workloads, Round Robin once per quantum.
+ *  Each workload is parsed once and shared by all of its cells; cells are
+ *  cached by (workload hash, policy, parameters) so a rerun only simulates
+ *  what is missing.
+ ************************************************************************************/
+// Totals rather than averages, so cached cells reproduce the table exactly
+struct RunSummary {
+    uint32_t processes = 0;
+    long long makespan = 0;
+    long long totalResponse = 0;
+    long long totalTurnaround = 0;
+    long long totalDelay = 0;
+    int maxDelay = 0;
+    size_t dispatches = 0;  // trace segments: context switches + 1
 };
 
-int main() {
+inline RunSummary summarize(const RunContext& run) {
+    RunSummary summary;
+    summary.processes = run.finishedProcesses.size();
+    for (uint32_t p : run.finishedProcesses) {
+        summary.makespan = max<long long>(summary.makespan, (long long)run.processes.arrivalTime[p] + run.turnaround[p]);
+        summary.totalResponse += run.responseTime[p];
+        summary.totalTurnaround += run.turnaround[p];
+        summary.totalDelay += run.delay[p];
+        summary.maxDelay = max(summary.maxDelay, run.delay[p]);
+    }
+    summary.dispatches = run.executionOrder.dispatches();
+    return summary;
+}
+
+using SweepKey = tuple<uint64_t, int, string>;  // workload hash, policy, params
+
+struct SweepCell {
+    size_t workload;
+    Policy policy;
+    int quantum;
+    string params;  // CPUScheduler::describeParams
+    RunSummary summary;
+};
+
+// "2,4,8", "1:100" or "1:100:5", and lists of those
+inline bool parseQuanta(const string& spec, vector<int>& quanta) {
+    stringstream items(spec);
+    string item;
+    while (getline(items, item, ',')) {
+        int bounds[3] = {0, 0, 1};
+        int fields = 0;
+        const char* p = item.data();
+        const char* end = p + item.size();
+        while (fields < 3) {
+            auto [next, ec] = from_chars(p, end, bounds[fields]);
+            if (ec != errc()) return false;
+            fields++;
+            p = next;
+            if (p == end) break;
+            if (*p++ != ':') return false;
+        }
+        if (p != end) return false;
+        if (fields == 1) bounds[1] = bounds[0];
+        if (bounds[0] < 1 || bounds[1] < bounds[0] || bounds[2] < 1) return false;
+        for (int q = bounds[0]; q <= bounds[1]; q += bounds[2]) quanta.push_back(q);
+    }
+    sort(quanta.begin(), quanta.end());
+    quanta.erase(unique(quanta.begin(), quanta.end()), quanta.end());
+    return !quanta.empty();
+}
+
+// One workload path per line; blank lines are skipped
+inline vector<string> readWorkloadList(const string& filename) {
+    ifstream file(filename);
+    if (!file) {
+        cerr << "Error opening file: " << filename << endl;
+        exit(1);
+    }
+    vector<string> workloads;
+    string line;
+    while (getline(file, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (!line.empty()) workloads.push_back(line);
+    }
+    return workloads;
+}
+
+// Cache lines: hash policy params processes makespan totalResponse
+// totalTurnaround totalDelay maxDelay dispatches; "-" stands for no params
+inline void loadSweepCache(const string& filename, map<SweepKey, RunSummary>& cache) {
+    ifstream file(filename);
+    string line;
+    while (getline(file, line)) {
+        stringstream fields(line);
+        uint64_t hash;
+        int policy;
+        string params;
+        RunSummary r;
+        if (fields >> hex >> hash >> dec >> policy >> params >> r.processes >> r.makespan >> r.totalResponse
+                   >> r.totalTurnaround >> r.totalDelay >> r.maxDelay >> r.dispatches)
+            cache[{hash, policy, params == "-" ? "" : params}] = r;
+    }
+}
+
+// `configure` applies the policy settings to each loaded workload
+inline void runSweep(const vector<string>& workloads, const vector<int>& quanta,
+                     const function<void(CPUScheduler&)>& configure, bool readPriority,
+                     const string& resultsFile, const string& cacheFile) {
+    ThreadPool pool;
+    map<SweepKey, RunSummary> cache;
+    loadSweepCache(cacheFile, cache);
+    
+    vector<unique_ptr<CPUScheduler>> schedulers(workloads.size());
+    vector<uint64_t> hashes(workloads.size());
+    for (size_t w = 0; w < workloads.size(); w++) {
+        pool.submit([&, w] {
+            schedulers[w] = make_unique<CPUScheduler>();
+            schedulers[w]->readInput(workloads[w], readPriority);
+            configure(*schedulers[w]);
+            hashes[w] = schedulers[w]->workloadHash();
+        });
+    }
+    pool.wait();
+    
+    vector<SweepCell> cells;
+    for (size_t w = 0; w < workloads.size(); w++) {
+        for (int p = 0; p < POLICY_COUNT; p++) {
+            Policy policy = (Policy)p;
+            if (policy == Policy::RoundRobin) {
+                for (int q : quanta) cells.push_back({w, policy, q, schedulers[w]->describeParams(policy, q), {}});
+            } else {
+                cells.push_back({w, policy, 0, schedulers[w]->describeParams(policy, 0), {}});
+            }
+        }
+    }
+    
+    size_t cachedCells = 0;
+    vector<size_t> fresh;
+    for (size_t c = 0; c < cells.size(); c++) {
+        const SweepCell& cell = cells[c];
+        auto it = cache.find({hashes[cell.workload], (int)cell.policy, cell.params});
+        if (it != cache.end()) {
+            cells[c].summary = it->second;
+            cachedCells++;
+        } else {
+            fresh.push_back(c);
+            pool.submit([&cells, &schedulers, c] {
+                SweepCell& cell = cells[c];
+                cell.summary = summarize(schedulers[cell.workload]->simulate(cell.policy, cell.quantum));
+            });
+        }
+    }
+    pool.wait();
+    
+    ofstream cacheOut(cacheFile, ios::app);
+    for (size_t c : fresh) {
+        const SweepCell& cell = cells[c];
+        const RunSummary& r = cell.summary;
+        cacheOut << hex << hashes[cell.workload] << dec << " " << (int)cell.policy << " "
+                 << (cell.params.empty() ? "-" : cell.params) << " "
+                 << r.processes << " " << r.makespan << " " << r.totalResponse << " " << r.totalTurnaround << " "
+                 << r.totalDelay << " " << r.maxDelay << " " << r.dispatches << "\n";
+    }
+    
+    ofstream out(resultsFile);
+    if (!out) {
+        cerr << "Error opening file: " << resultsFile << endl;
+        exit(1);
+    }
+    out << "workload,policy,params,processes,makespan,avg_response,avg_turnaround,avg_delay,max_delay,dispatches\n";
+    out << fixed << setprecision(3);
+    for (const SweepCell& cell : cells) {
+        const RunSummary& r = cell.summary;
+        double n = max<uint32_t>(1, r.processes);
+        out << workloads[cell.workload] << "," << POLICY_NAMES[(int)cell.policy] << ",";
+        out << cell.params << "," << r.processes << "," << r.makespan << "," << r.totalResponse / n << ","
+            << r.totalTurnaround / n << "," << r.totalDelay / n << "," << r.maxDelay << "," << r.dispatches << "\n";
+    }
+    
+    cout << "Sweep: " << cells.size() << " cells over " << workloads.size() << " workloads ("
+         << cachedCells << " from cache), results in " << resultsFile << endl;
+}
+
+/*************************************************************************************
+ *  Benchmark
+ *  Generates one workload per size and times every policy on it in turn.
+ *  Events are arrivals, completions and dispatches (trace segments). Memory
+ *  is the peak resident set during a run above what was resident before it;
+ *  the peak is reset through /proc/self/clear_refs, so it reads 0 off Linux.
+ ************************************************************************************/
+inline long long statusKb(const char* field) {
+    ifstream status("/proc/self/status");
+    string line;
+    size_t n = strlen(field);
+    while (getline(status, line)) {
+        if (line.compare(0, n, field) == 0) return atoll(line.c_str() + n);
+    }
+    return 0;
+}
+
+inline void resetPeakResident() {
+    ofstream clear("/proc/self/clear_refs");
+    clear << "5";
+}
+
+// "1000,1e6,1e8" -> {1000, 1000000, 100000000}
+inline bool parseSizes(const string& spec, vector<size_t>& sizes) {
+    stringstream items(spec);
+    string item;
+    while (getline(items, item, ',')) {
+        char* end;
+        double v = strtod(item.c_str(), &end);
+        if (end == item.c_str() || *end || v < 1 || v > UINT32_MAX) return false;
+        sizes.push_back((size_t)v);
+    }
+    return !sizes.empty();
+}
+
+inline void runBenchmark(CPUScheduler& scheduler, WorkloadSpec spec, const vector<size_t>& sizes, int timeQuantum) {
+    cout << "Benchmark: " << describe(spec.arrivals) << " arrivals, " << describe(spec.bursts)
+         << " bursts (mean " << spec.meanBurst << "), load " << spec.load << ", seed " << spec.seed << endl;
+    cout << setw(10) << "processes" << "  " << left << setw(14) << "policy" << right << setw(10) << "seconds"
+         << setw(13) << "events" << setw(13) << "events/s" << setw(10) << "peak MB" << endl;
+    cout << fixed;
+    for (size_t n : sizes) {
+        spec.count = n;
+        scheduler.load(generateWorkload(spec), true);
+        for (int p = 0; p < POLICY_COUNT; p++) {
+            long long before = statusKb("VmRSS:");
+            resetPeakResident();
+            auto start = chrono::steady_clock::now();
+            size_t events;
+            {
+                RunContext run = scheduler.simulate((Policy)p, timeQuantum);
+                events = 2 * run.finishedProcesses.size() + run.executionOrder.dispatches();
+            }
+            double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            long long peak = max(0ll, statusKb("VmHWM:") - before);
+            
+            cout << setw(10) << n << "  " << left << setw(14) << POLICY_NAMES[p] << right
+                 << setprecision(3) << setw(10) << seconds << setw(13) << events
+                 << setprecision(0) << setw(13) << (seconds > 0 ? events / seconds : 0.0)
+                 << setprecision(1) << setw(10) << peak / 1024.0 << endl;
+        }
+    }
+}
+
+/*************************************************************************************
+ *  Incremental re-simulation
+ *  Runs every policy on the input with checkpoints, appends the processes of
+ *  a second trace and brings each run up to date from its latest checkpoint
+ *  before the earliest appended arrival. Reports are those of a full run of
+ *  the combined workload; the timings show what the resume saved.
+ ************************************************************************************/
+inline void runAppend(CPUScheduler& scheduler, const string& appendFile, bool readPriority,
+                      int checkpointInterval, int timeQuantum) {
+    const ProcessTable& table = scheduler.table();
+    if (checkpointInterval <= 0) {
+        // About 64 checkpoints up to the last arrival
+        int lastArrival = table.size() ? table.arrivalTime[scheduler.arrivalOrder().back()] : 0;
+        checkpointInterval = lastArrival / 64 + 1;
+    }
+    
+    auto seconds = [](auto start) { return chrono::duration<double>(chrono::steady_clock::now() - start).count(); };
+    vector<IncrementalRun> runs(POLICY_COUNT);
+    vector<double> fullSeconds(POLICY_COUNT);
+    for (int p = 0; p < POLICY_COUNT; p++) {
+        auto start = chrono::steady_clock::now();
+        scheduler.runIncremental((Policy)p, checkpointInterval, runs[p], timeQuantum);
+        fullSeconds[p] = seconds(start);
+    }
+    
+    CPUScheduler added;
+    added.readInput(appendFile, readPriority);
+    const ProcessTable& rows = added.table();
+    vector<string_view> names(rows.size());
+    for (uint32_t i = 0; i < rows.size(); i++) names[i] = rows.names[i];
+    cpusched::Status status = scheduler.append(rows.arrivalTime, rows.processingTime,
+                                               added.hasPriority() ? span<const int>(rows.priority) : span<const int>(), names);
+    if (!status.ok()) {
+        cerr << "Error appending " << appendFile << ": " << status.error << endl;
+        exit(1);
+    }
+    
+    cout << "Appended " << rows.size() << " processes to " << table.size() - rows.size()
+         << ", checkpoint interval " << checkpointInterval << endl;
+    cout << left << setw(14) << "policy" << right << setw(12) << "full s" << setw(12) << "resume s"
+         << setw(14) << "resumed at" << setw(13) << "checkpoints" << endl;
+    cout << fixed << setprecision(4);
+    vector<RunStats> stats(POLICY_COUNT);
+    for (int p = 0; p < POLICY_COUNT; p++) {
+        auto start = chrono::steady_clock::now();
+        scheduler.resume(runs[p]);
+        double resumeSeconds = seconds(start);
+        cout << left << setw(14) << POLICY_NAMES[p] << right << setw(12) << fullSeconds[p] << setw(12) << resumeSeconds
+             << setw(14) << (runs[p].resumedAt < 0 ? string("start") : to_string(runs[p].resumedAt))
+             << setw(13) << runs[p].log.saved.size() << endl;
+        
+        if (scheduler.writesPerProcessOutput()) scheduler.writeOutput(POLICY_OUTPUT_FILES[p], runs[p].result());
+        stats[p] = runs[p].result().stats;
+    }
+    scheduler.writeStats("out_stats.txt", stats, timeQuantum);
+}
+
+int main(int argc, char* argv[]) {
     CPUScheduler scheduler;
-    scheduler.readInput("in.txt");
+    string inputFile = "in.txt", binaryFile;
+    string workloadList, quantaSpec = "2", resultsFile = "sweep_results.csv", cacheFile = "sweep_cache.txt";
+    string textFile, sizesSpec = "1000,10000,100000,1000000", appendFile;
+    bool readPriority = false, sweep = false, generate = false, bench = false, execute = false;
+    int timeQuantum = 2;
+    int checkpointInterval = 0;  // 0: picked from the workload
+    WorkloadSpec spec;
+    ExecConfig exec;
+    CfsConfig cfs;
+    AgingConfig aging;
+    MlfqConfig mlfq;
+    SmpConfig smp;
+    smp.cpus = 0;  // 0: single-CPU policies
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--input" && i + 1 < argc) {
+            inputFile = argv[++i];
+        } else if (arg == "--quantum" && i + 1 < argc) {
+            timeQuantum = max(1, atoi(argv[++i]));
+        } else if (arg == "--cfs-latency" && i + 1 < argc) {
+            cfs.targetLatency = max(1, atoi(argv[++i]));
+        } else if (arg == "--cfs-granularity" && i + 1 < argc) {
+            cfs.minGranularity = max(1, atoi(argv[++i]));
+        } else if (arg == "--aging-interval" && i + 1 < argc) {
+            aging.interval = max(1, atoi(argv[++i]));
+        } else if (arg == "--mlfq-quanta" && i + 1 < argc) {
+            mlfq.quanta.clear();
+            stringstream items(argv[++i]);
+            string item;
+            while (getline(items, item, ',')) mlfq.quanta.push_back(max(1, atoi(item.c_str())));
+            if (mlfq.quanta.empty()) mlfq.quanta.push_back(1);
+        } else if (arg == "--mlfq-boost" && i + 1 < argc) {
+            mlfq.boostInterval = max(1, atoi(argv[++i]));
+        } else if (arg == "--smp" && i + 1 < argc) {
+            smp.cpus = max(1, atoi(argv[++i]));
+        } else if (arg == "--balance" && i + 1 < argc) {
+            string modes = argv[++i];
+            smp.push = modes.find("push") != string::npos;
+            smp.pull = modes.find("pull") != string::npos;
+            smp.steal = modes.find("steal") != string::npos;
+        } else if (arg == "--migration-cost" && i + 1 < argc) {
+            smp.migrationCost = max(0, atoi(argv[++i]));
+        } else if (arg == "--balance-interval" && i + 1 < argc) {
+            smp.balanceInterval = max(1, atoi(argv[++i]));
+        } else if (arg == "--sweep") {
+            sweep = true;
+        } else if (arg == "--quanta" && i + 1 < argc) {
+            quantaSpec = argv[++i];
+        } else if (arg == "--workloads" && i + 1 < argc) {
+            workloadList = argv[++i];
+        } else if (arg == "--results" && i + 1 < argc) {
+            resultsFile = argv[++i];
+        } else if (arg == "--cache" && i + 1 < argc) {
+            cacheFile = argv[++i];
+        } else if (arg == "--priority") {
+            readPriority = true;
+        } else if (arg == "--stats-only") {
+            scheduler.setPerProcessOutput(false);
+        } else if (arg == "--write-binary" && i + 1 < argc) {
+            binaryFile = argv[++i];
+        } else if (arg == "--write-text" && i + 1 < argc) {
+            textFile = argv[++i];
+        } else if (arg == "--generate" && i + 1 < argc) {
+            generate = true;
+            spec.count = strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            spec.seed = strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--load" && i + 1 < argc) {
+            spec.load = max(1e-6, atof(argv[++i]));
+        } else if (arg == "--arrivals" && i + 1 < argc && string(argv[i + 1]) == "poisson") {
+            spec.arrivals = ArrivalPattern::Poisson;
+            i++;
+        } else if (arg == "--arrivals" && i + 1 < argc && string(argv[i + 1]) == "bursty") {
+            spec.arrivals = ArrivalPattern::Bursty;
+            i++;
+        } else if (arg == "--batch" && i + 1 < argc) {
+            spec.batchSize = max(1.0, atof(argv[++i]));
+        } else if (arg == "--bursts" && i + 1 < argc && string(argv[i + 1]) == "exponential") {
+            spec.bursts = BurstDistribution::Exponential;
+            i++;
+        } else if (arg == "--bursts" && i + 1 < argc && string(argv[i + 1]) == "pareto") {
+            spec.bursts = BurstDistribution::Pareto;
+            i++;
+        } else if (arg == "--bursts" && i + 1 < argc && string(argv[i + 1]) == "bimodal") {
+            spec.bursts = BurstDistribution::Bimodal;
+            i++;
+        } else if (arg == "--mean-burst" && i + 1 < argc) {
+            spec.meanBurst = max(1.0, atof(argv[++i]));
+        } else if (arg == "--pareto-shape" && i + 1 < argc) {
+            spec.paretoShape = atof(argv[++i]);
+        } else if (arg == "--priorities" && i + 1 < argc && string(argv[i + 1]) == "uniform") {
+            spec.priorities = PriorityMix::Uniform;
+            i++;
+        } else if (arg == "--priorities" && i + 1 < argc && string(argv[i + 1]) == "skewed") {
+            spec.priorities = PriorityMix::Skewed;
+            i++;
+        } else if (arg == "--priority-levels" && i + 1 < argc) {
+            spec.priorityLevels = max(1, atoi(argv[++i]));
+        } else if (arg == "--execute") {
+            execute = true;
+        } else if (arg == "--workers" && i + 1 < argc) {
+            exec.workers = max(1, atoi(argv[++i]));
+        } else if (arg == "--tick-us" && i + 1 < argc) {
+            exec.tickMicros = max(1, atoi(argv[++i]));
+        } else if (arg == "--bench") {
+            bench = true;
+        } else if (arg == "--sizes" && i + 1 < argc) {
+            sizesSpec = argv[++i];
+        } else if (arg == "--append" && i + 1 < argc) {
+            appendFile = argv[++i];
+        } else if (arg == "--checkpoint-interval" && i + 1 < argc) {
+            checkpointInterval = max(1, atoi(argv[++i]));
+        } else if (arg == "--trace" && i + 1 < argc && string(argv[i + 1]) == "segments") {
+            scheduler.setTraceFormat(TraceFormat::Segments);
+            i++;
+        } else if (arg == "--trace" && i + 1 < argc && string(argv[i + 1]) == "legacy") {
+            i++;
+        } else {
+            cerr << "Usage: " << argv[0] << " [--input FILE] [--priority] [--quantum Q] [--trace legacy|segments]" << endl;
+            cerr << "              [--cfs-latency L] [--cfs-granularity G] [--aging-interval T]" << endl;
+            cerr << "              [--mlfq-quanta Q0,Q1,...] [--mlfq-boost T] [--stats-only]" << endl;
+            cerr << "       " << argv[0] << " [--input FILE] [--priority] [--quantum Q] --smp CPUS [--balance push,pull,steal]" << endl;
+            cerr << "              [--migration-cost C] [--balance-interval T]" << endl;
+            cerr << "       " << argv[0] << " [--input FILE] [--priority] [--quantum Q] --execute [--workers N] [--tick-us U]" << endl;
+            cerr << "       " << argv[0] << " [--input FILE] [--priority] [--write-binary FILE] [--write-text FILE]" << endl;
+            cerr << "       " << argv[0] << " --generate N [--seed S] [--load L] [--arrivals poisson|bursty] [--batch B]" << endl;
+            cerr << "              [--bursts exponential|pareto|bimodal] [--mean-burst M] [--pareto-shape A]" << endl;
+            cerr << "              [--priorities uniform|skewed] [--priority-levels K] [any mode above]" << endl;
+            cerr << "       " << argv[0] << " [--input FILE] [--priority] [policy options] --append FILE [--checkpoint-interval T]" << endl;
+            cerr << "       " << argv[0] << " --bench [--sizes N1,N2,...] [generator options] [policy options]" << endl;
+            cerr << "       " << argv[0] << " --sweep [--quanta 1:100[:STEP],...] [--workloads LIST] [--input FILE]" << endl;
+            cerr << "              [--priority] [--results FILE] [--cache FILE]" << endl;
+            return 1;
+        }
+    }
+    
+    auto configure = [&](CPUScheduler& s) {
+        s.setCfsConfig(cfs);
+        s.setAgingConfig(aging);
+        s.setMlfqConfig(mlfq);
+    };
+    
+    if (sweep) {
+        vector<int> quanta;
+        if (!parseQuanta(quantaSpec, quanta)) {
+            cerr << "Invalid quanta: " << quantaSpec << endl;
+            return 1;
+        }
+        vector<string> workloads = workloadList.empty() ? vector<string>{inputFile} : readWorkloadList(workloadList);
+        runSweep(workloads, quanta, configure, readPriority, resultsFile, cacheFile);
+        return 0;
+    }
+    
+    if (bench) {
+        vector<size_t> sizes;
+        if (!parseSizes(sizesSpec, sizes)) {
+            cerr << "Invalid sizes: " << sizesSpec << endl;
+            return 1;
+        }
+        configure(scheduler);
+        runBenchmark(scheduler, spec, sizes, timeQuantum);
+        return 0;
+    }
+    
+    // A generated workload always carries its priorities
+    if (generate) scheduler.load(generateWorkload(spec), true);
+    else scheduler.readInput(inputFile, readPriority);
+    configure(scheduler);
+    
+    // Write the trace out instead of scheduling it
+    if (!binaryFile.empty() || !textFile.empty()) {
+        if (!binaryFile.empty() && !scheduler.writeBinary(binaryFile)) {
+            cerr << "Error opening file: " << binaryFile << endl;
+            return 1;
+        }
+        if (!textFile.empty() && !scheduler.writeText(textFile)) {
+            cerr << "Error opening file: " << textFile << endl;
+            return 1;
+        }
+        if (!binaryFile.empty()) cout << "Binary trace written to " << binaryFile << endl;
+        if (!textFile.empty()) cout << "Text trace written to " << textFile << endl;
+        return 0;
+    }
+    
+    if (smp.cpus > 0) {
+        smp.timeQuantum = timeQuantum;
+        runSmp(scheduler, smp);
+        return 0;
+    }
+    
+    if (execute) {
+        exec.timeQuantum = timeQuantum;
+        runExecution(scheduler, exec);
+        return 0;
+    }
+    
+    if (!appendFile.empty()) {
+        runAppend(scheduler, appendFile, readPriority, checkpointInterval, timeQuantum);
+        return 0;
+    }
     
     // Run all algorithms
-    scheduler.runAll(2); // 2 is the time quantum for Round Robin
+    scheduler.runAll(timeQuantum); // quantum for Round Robin, 2 by default
     
     cout << "All processes are DONE!\n";
     return 0;
@@ -0,0 +1,1427 @@
+/*************************************************************************************
+ *  CPU scheduling simulator library (header-only)
+ *  Policies: FCFS, SJF, LJF, Round Robin, Priority, SRTF, CFS, Priority with
+ *  aging, MLFQ
+ *
+ *  The simulation engine behind CPUscheduler.cpp, usable in-process. Nothing
+ *  in here touches files, prints or exits: a cpusched::Simulator takes a
+ *  workload as spans of arrival/burst/priority, and run() hands back the
+ *  per-process metrics, the execution trace and the aggregate stats as plain
+ *  arrays. Bad input comes back as a Status. Every simulation is const and
+ *  owns its RunContext, so one Simulator can serve many concurrent runs.
+ ************************************************************************************/
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <queue>
+#include <set>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace cpusched {
+
+/*************************************************************************************
+ *  Workload and run state
+ ************************************************************************************/
+// All process names packed into one buffer; name i is chars[offsets[i] ..
+// offsets[i + 1]). Each name is stored once, at load time.
+struct NameTable {
+    std::vector<char> chars;
+    std::vector<uint32_t> offsets = {0};
+    
+    void add(std::string_view name) {
+        chars.insert(chars.end(), name.begin(), name.end());
+        offsets.push_back(chars.size());
+    }
+    
+    std::string_view operator[](uint32_t i) const {
+        return std::string_view(chars.data() + offsets[i], offsets[i + 1] - offsets[i]);
+    }
+};
+
+// Columnar process table. Row i is the i-th process of the input file; ready
+// queues, finish lists and the trace all hold 32-bit row indices. The table
+// is filled once by readInput and is read-only while policies run; per-run
+// state lives in a RunContext.
+struct ProcessTable {
+    NameTable names;
+    std::vector<int> arrivalTime;
+    std::vector<int> processingTime;
+    std::vector<int> priority;
+    
+    uint32_t size() const { return arrivalTime.size(); }
+    
+    void reserve(size_t n) {
+        names.offsets.reserve(n + 1);
+        arrivalTime.reserve(n);
+        processingTime.reserve(n);
+        priority.reserve(n);
+    }
+    
+    // Size the input columns for n rows that are then filled in place
+    void resizeInput(size_t n) {
+        arrivalTime.resize(n);
+        processingTime.resize(n);
+        priority.resize(n);
+        names.offsets.resize(n + 1);
+    }
+    
+    void add(std::string_view name, int arrival, int processing, int prio) {
+        names.add(name);
+        arrivalTime.push_back(arrival);
+        processingTime.push_back(processing);
+        priority.push_back(prio);
+    }
+    
+    // Comparators: true when row a goes before row b
+    static bool compareLJF(const ProcessTable& t, uint32_t a, uint32_t b) {
+        if (t.processingTime[a] != t.processingTime[b])
+            return t.processingTime[a] > t.processingTime[b];
+        return t.arrivalTime[a] < t.arrivalTime[b];
+    }
+    
+    static bool compareSJF(const ProcessTable& t, uint32_t a, uint32_t b) {
+        if (t.processingTime[a] != t.processingTime[b])
+            return t.processingTime[a] < t.processingTime[b];
+        return t.arrivalTime[a] < t.arrivalTime[b];
+    }
+    
+    static bool compareFCFS(const ProcessTable& t, uint32_t a, uint32_t b) {
+        return t.arrivalTime[a] < t.arrivalTime[b];
+    }
+    
+    static bool comparePriority(const ProcessTable& t, uint32_t a, uint32_t b) {
+        if (t.priority[a] != t.priority[b])
+            return t.priority[a] < t.priority[b]; // Lower number = higher priority
+        return t.arrivalTime[a] < t.arrivalTime[b];
+    }
+};
+
+// One stretch of CPU time given to a single process. `slices` is how many
+// entries the legacy trace prints for it: one per tick in SRTF, one per
+// quantum in Round Robin and one per dispatch in the other policies.
+struct TraceSegment {
+    uint32_t pid;
+    int start;
+    int end;
+    int slices;
+};
+
+// Run-length execution trace. Back-to-back segments of the same process are
+// merged, so a trace costs one entry per context switch rather than one
+// name string per tick or quantum.
+class ExecutionTrace {
+private:
+    std::vector<TraceSegment> segments;
+    bool recording = true;
+    size_t count = 0;  // segments, counted even when not recording
+    uint32_t lastPid = 0;
+    int lastEnd = 0;
+
+public:
+    void clear() {
+        segments.clear();
+        count = 0;
+    }
+    void setRecording(bool on) { recording = on; }
+    
+    void append(uint32_t pid, int start, int end, int slices = 1) {
+        bool extends = count > 0 && lastPid == pid && lastEnd == start;
+        if (!extends) count++;
+        lastPid = pid;
+        lastEnd = end;
+        if (!recording) return;
+        if (extends) {
+            segments.back().end = end;
+            segments.back().slices += slices;
+        } else {
+            segments.push_back({pid, start, end, slices});
+        }
+    }
+    
+    const std::vector<TraceSegment>& get() const { return segments; }
+    std::vector<TraceSegment> release() { return std::move(segments); }
+    size_t dispatches() const { return count; }
+    
+    // Where the trace stood at some moment, to cut it back there later. The
+    // last segment is kept whole because later appends may extend it.
+    struct Mark {
+        size_t segments = 0;
+        TraceSegment last{};
+        size_t count = 0;
+        uint32_t lastPid = 0;
+        int lastEnd = 0;
+    };
+    
+    Mark mark() const {
+        Mark m{segments.size(), {}, count, lastPid, lastEnd};
+        if (!segments.empty()) m.last = segments.back();
+        return m;
+    }
+    
+    void rollBack(const Mark& m) {
+        segments.resize(std::min(segments.size(), m.segments));
+        if (!segments.empty()) segments.back() = m.last;
+        count = m.count;
+        lastPid = m.lastPid;
+        lastEnd = m.lastEnd;
+    }
+};
+
+// Log-linear histogram in the HDR style. Values below SUB_COUNT get a bucket
+// each; larger ones keep their top SUB_BITS bits, so any recorded value is
+// reported within 1/64 of itself. Memory is fixed (about 29 KB) no matter how
+// many values go in.
+class LatencyHistogram {
+private:
+    static constexpr int SUB_BITS = 7;
+    static constexpr int SUB_COUNT = 1 << SUB_BITS;
+    static constexpr int HALF = SUB_COUNT / 2;
+    static constexpr int BUCKETS = (63 - (SUB_BITS - 1)) * HALF + SUB_COUNT;
+    
+    std::array<uint64_t, BUCKETS> counts{};
+    uint64_t total = 0;
+    long double sum = 0;
+    long long maxValue = 0;
+    
+    static int bucketOf(long long v) {
+        if (v < SUB_COUNT) return (int)v;
+        int shift = (63 - __builtin_clzll((unsigned long long)v)) - (SUB_BITS - 1);
+        return shift * HALF + (int)(v >> shift);
+    }
+    
+    // Largest value that lands in bucket b
+    static long long highestIn(int b) {
+        if (b < SUB_COUNT) return b;
+        int shift = b / HALF - 1;
+        long long low = (long long)(b - shift * HALF) << shift;
+        return low + (1ll << shift) - 1;
+    }
+
+public:
+    void record(long long v) {
+        v = std::max(0ll, v);
+        counts[bucketOf(v)]++;
+        total++;
+        sum += v;
+        maxValue = std::max(maxValue, v);
+    }
+    
+    uint64_t count() const { return total; }
+    long long highest() const { return maxValue; }
+    double mean() const { return total ? (double)(sum / total) : 0.0; }
+    
+    // Smallest recorded value v such that a fraction q of the values are <= v
+    // (up to bucket precision)
+    long long percentile(double q) const {
+        if (total == 0) return 0;
+        uint64_t rank = std::max<uint64_t>(1, (uint64_t)std::ceil(q * total));
+        uint64_t seen = 0;
+        for (int b = 0; b < BUCKETS; b++) {
+            seen += counts[b];
+            if (seen >= rank) return std::min(highestIn(b), maxValue);
+        }
+        return maxValue;
+    }
+};
+
+// Streaming aggregates of one run, fed as each process finishes
+struct RunStats {
+    LatencyHistogram response;
+    LatencyHistogram turnaround;
+    LatencyHistogram delay;
+    long long busyTime = 0;       // CPU time of the finished processes
+    int firstArrival = INT_MAX;
+    int lastCompletion = 0;
+    
+    void record(int arrival, int burst, int completion, int responseTime, int turnaroundTime, int delayTime) {
+        response.record(responseTime);
+        turnaround.record(turnaroundTime);
+        delay.record(delayTime);
+        busyTime += burst;
+        firstArrival = std::min(firstArrival, arrival);
+        lastCompletion = std::max(lastCompletion, completion);
+    }
+    
+    long long span() const { return turnaround.count() ? (long long)lastCompletion - firstArrival : 0; }
+    double throughput() const { return span() > 0 ? (double)turnaround.count() / span() : 0.0; }
+    double utilization() const { return span() > 0 ? (double)busyTime / span() : 0.0; }
+};
+
+// Mutable state of one policy run over a shared, read-only ProcessTable.
+// Each run owns its context, so several policies can run at once.
+struct RunContext {
+    const ProcessTable& processes;
+    std::vector<int> remainingTime;
+    std::vector<int> responseTime;
+    std::vector<int> turnaround;
+    std::vector<int> delay;
+    std::vector<char> hasStarted;
+    ExecutionTrace executionOrder;
+    std::vector<uint32_t> finishedProcesses;
+    RunStats stats;
+    
+    // Without recordTrace the execution trace stays empty; the metrics and
+    // stats are kept either way
+    explicit RunContext(const ProcessTable& table, bool recordTrace = true)
+        : processes(table), remainingTime(table.processingTime), responseTime(table.size(), 0),
+          turnaround(table.size(), 0), delay(table.size(), 0), hasStarted(table.size(), 0) {
+        finishedProcesses.reserve(table.size());
+        executionOrder.setRecording(recordTrace);
+    }
+    
+    void finish(uint32_t p, int currentTime) {
+        turnaround[p] = currentTime - processes.arrivalTime[p];
+        delay[p] = turnaround[p] - processes.processingTime[p];
+        finishedProcesses.push_back(p);
+        stats.record(processes.arrivalTime[p], processes.processingTime[p], currentTime,
+                     responseTime[p], turnaround[p], delay[p]);
+    }
+    
+    static bool compareSRTF(const RunContext& r, uint32_t a, uint32_t b) {
+        if (r.remainingTime[a] != r.remainingTime[b])
+            return r.remainingTime[a] < r.remainingTime[b];
+        return r.processes.arrivalTime[a] < r.processes.arrivalTime[b];
+    }
+};
+
+/*************************************************************************************
+ *  Policies
+ ************************************************************************************/
+enum class Policy { FCFS, SJF, LJF, RoundRobin, Priority, SRTF, CFS, PriorityAging, MLFQ };
+const int POLICY_COUNT = 9;
+
+const char* const POLICY_NAMES[POLICY_COUNT] = {
+    "FCFS", "SJF", "LJF", "RR", "Priority", "SRTF", "CFS", "PriorityAging", "MLFQ",
+};
+
+// Ready-queue orders for Simulator::simulateNonPreemptive. A new
+// non-preemptive policy only needs a struct like these: `before` is true
+// when row a must run ahead of row b.
+struct ShortestJobFirst {
+    static bool before(const ProcessTable& t, uint32_t a, uint32_t b) { return ProcessTable::compareSJF(t, a, b); }
+};
+
+struct LongestJobFirst {
+    static bool before(const ProcessTable& t, uint32_t a, uint32_t b) { return ProcessTable::compareLJF(t, a, b); }
+};
+
+struct HighestPriorityFirst {
+    static bool before(const ProcessTable& t, uint32_t a, uint32_t b) { return ProcessTable::comparePriority(t, a, b); }
+};
+
+// Linux sched_prio_to_weight, indexed by nice + 20. Each nice step is ~10% CPU.
+const int NICE_TO_WEIGHT[40] = {
+    /* -20 */ 88761, 71755, 56483, 46273, 36291,
+    /* -15 */ 29154, 23254, 18705, 14949, 11916,
+    /* -10 */  9548,  7620,  6100,  4904,  3906,
+    /*  -5 */  3121,  2501,  1991,  1586,  1277,
+    /*   0 */  1024,   820,   655,   526,   423,
+    /*   5 */   335,   272,   215,   172,   137,
+    /*  10 */   110,    87,    70,    56,    45,
+    /*  15 */    36,    29,    23,    18,    15,
+};
+const int NICE_0_WEIGHT = 1024;
+
+struct CfsConfig {
+    int targetLatency = 8;   // period in which every runnable process runs once
+    int minGranularity = 1;  // shortest slice; many runnable processes stretch the period
+};
+
+struct AgingConfig {
+    int interval = 5;  // a waiting process gains one priority level per interval
+};
+
+struct MlfqConfig {
+    std::vector<int> quanta = {2, 4, 8};  // time slice per level, top level first
+    int boostInterval = 50;               // every process returns to the top level this often
+};
+
+/*************************************************************************************
+ *  Checkpoints
+ *  A policy loop can save its state at the top of an iteration, where
+ *  nothing is half done. Up to that point the run has only looked at
+ *  processes arriving at or before the checkpoint's time, so after the
+ *  workload changes from time t on, any checkpoint taken before t is still
+ *  valid and the run can continue from it.
+ ************************************************************************************/
+// Only live processes (arrived, not finished) are stored, in the engine's
+// queue order, so a checkpoint costs O(ready set) rather than O(n). Rows
+// finished before it are final in the run being resumed, and rows not
+// arrived yet start fresh.
+struct Checkpoint {
+    int time = 0;
+    uint32_t cursor = 0;               // arrivals consumed
+    uint32_t finished = 0;             // length of finishedProcesses
+    ExecutionTrace::Mark trace;
+    RunStats stats;
+    std::vector<uint32_t> live;
+    std::vector<int> remaining;        // per live process
+    std::vector<int> response;         // per live process, -1 before its first dispatch
+    std::vector<long long> extra;      // engine state per live process (vruntime, aging key, ...)
+    std::vector<long long> values;     // engine scalars
+    
+    void addLive(const RunContext& run, uint32_t p) {
+        live.push_back(p);
+        remaining.push_back(run.remainingTime[p]);
+        response.push_back(run.hasStarted[p] ? run.responseTime[p] : -1);
+    }
+    
+    size_t bytes() const {
+        return sizeof(Checkpoint) + live.size() * (sizeof(uint32_t) + 2 * sizeof(int)) +
+               (extra.size() + values.size()) * sizeof(long long);
+    }
+};
+
+// The checkpoints of one run. While `from` is set the engine starts from
+// that checkpoint, with `resumeInto` (the run's context, already rolled
+// back) as its RunContext. An overloaded workload keeps most processes live,
+// so once the checkpoints pass `budget` bytes every other one is dropped and
+// the interval doubles.
+struct CheckpointLog {
+    int interval = 0;                  // simulated time between checkpoints
+    size_t budget = 64 << 20;
+    long long nextAt = 0;
+    std::vector<Checkpoint> saved;     // by time
+    size_t savedBytes = 0;             // all but the last checkpoint, which may still be filling
+    const Checkpoint* from = nullptr;
+    RunContext* resumeInto = nullptr;
+    
+    bool due(int time) {
+        if (interval <= 0 || time < nextAt) return false;
+        if (!saved.empty() && savedBytes + saved.back().bytes() > budget) thin();
+        return time >= nextAt;
+    }
+    
+    // Keeps the latest checkpoint and every second one before it
+    void thin() {
+        size_t last = saved.size() - 1, kept = 0;
+        for (size_t i = last % 2; i <= last; i += 2) {
+            if (i != kept) saved[kept] = std::move(saved[i]);
+            kept++;
+        }
+        saved.resize(kept);
+        countBytes();
+        interval = std::min<long long>(INT_MAX / 2, 2ll * interval);
+        nextAt = (long long)saved.back().time + interval;
+    }
+    
+    void countBytes() {
+        savedBytes = 0;
+        for (size_t i = 0; i + 1 < saved.size(); i++) savedBytes += saved[i].bytes();
+    }
+    
+    Checkpoint& save(const RunContext& run, int time, uint32_t cursor) {
+        if (!saved.empty()) savedBytes += saved.back().bytes();
+        Checkpoint& c = saved.emplace_back();
+        c.time = time;
+        c.cursor = cursor;
+        c.finished = run.finishedProcesses.size();
+        c.trace = run.executionOrder.mark();
+        c.stats = run.stats;
+        nextAt = (long long)time + interval;
+        return c;
+    }
+};
+
+// A policy run kept up to date across workload edits with Simulator::resume.
+// It refers to the Simulator's table, so it must not outlive it.
+struct IncrementalRun {
+    Policy policy = Policy::FCFS;
+    int timeQuantum = 2;
+    size_t version = 0;                // workload edits already applied
+    int resumedAt = -1;                // time the last resume() started from, -1 for time 0
+    CheckpointLog log;
+    std::unique_ptr<RunContext> context;
+    
+    const RunContext& result() const { return *context; }
+};
+
+// std::priority_queue whose contents a checkpoint can read
+template <class Compare>
+class ReadyHeap : public std::priority_queue<uint32_t, std::vector<uint32_t>, Compare> {
+public:
+    using std::priority_queue<uint32_t, std::vector<uint32_t>, Compare>::priority_queue;
+    
+    const std::vector<uint32_t>& items() const { return this->c; }
+};
+
+/*************************************************************************************
+ *  Simulator
+ ************************************************************************************/
+// Outcome of a call that can reject its input; `error` is empty on success
+struct Status {
+    std::string error;
+    
+    bool ok() const { return error.empty(); }
+};
+
+// One run in plain arrays. The metric columns are indexed by input row;
+// completionOrder lists the rows as they finished.
+struct SimulationResult {
+    std::vector<int> responseTime;
+    std::vector<int> turnaround;
+    std::vector<int> delay;
+    std::vector<uint32_t> completionOrder;
+    std::vector<TraceSegment> trace;  // empty when trace recording is off
+    RunStats stats;
+};
+
+class Simulator {
+protected:
+    // Read-only once a workload is loaded; the policies below are const and
+    // keep their state in a RunContext, so they may run concurrently.
+    ProcessTable processes;
+    std::vector<uint32_t> arrivals;  // row indices by arrival time, ties by input line
+    CfsConfig cfs;
+    AgingConfig aging;
+    MlfqConfig mlfq;
+    bool recordTrace = true;
+    bool priorityFromInput = false;  // otherwise the priority column holds row indices
+    std::vector<int> editTimes;      // per workload edit, the earliest arrival it touched
+    
+    void sortArrivals() {
+        arrivals.resize(processes.size());
+        for (uint32_t i = 0; i < arrivals.size(); i++) arrivals[i] = i;
+        std::stable_sort(arrivals.begin(), arrivals.end(), [this](uint32_t a, uint32_t b) {
+            return ProcessTable::compareFCFS(processes, a, b);
+        });
+    }
+    
+    // Position of the first arrival at or after `time`
+    size_t firstArrivalFrom(int time) const {
+        return std::partition_point(arrivals.begin(), arrivals.end(), [&](uint32_t p) {
+            return processes.arrivalTime[p] < time;
+        }) - arrivals.begin();
+    }
+    
+    // Restores the arrival order after an edit left arrivals[0, from) alone
+    void sortArrivalsFrom(size_t from) {
+        std::sort(arrivals.begin() + from, arrivals.end(), [this](uint32_t a, uint32_t b) {
+            if (processes.arrivalTime[a] != processes.arrivalTime[b]) return processes.arrivalTime[a] < processes.arrivalTime[b];
+            return a < b;
+        });
+    }
+    
+    static Status checkColumns(std::span<const int> arrival, std::span<const int> burst,
+                               std::span<const int> priority, std::span<const std::string_view> names) {
+        size_t n = arrival.size();
+        if (burst.size() != n || (!priority.empty() && priority.size() != n) || (!names.empty() && names.size() != n))
+            return {"column lengths differ"};
+        if (n >= UINT32_MAX) return {"too many processes"};
+        for (size_t i = 0; i < n; i++) {
+            if (arrival[i] < 0) return {"negative arrival time in row " + std::to_string(i)};
+            if (burst[i] < 1) return {"burst time below 1 in row " + std::to_string(i)};
+        }
+        return {};
+    }
+    
+    // Adds checked columns to `table`; generated names and priorities count
+    // from its current size
+    static void addRows(ProcessTable& table, std::span<const int> arrival, std::span<const int> burst,
+                        std::span<const int> priority, std::span<const std::string_view> names) {
+        size_t first = table.size();
+        char generated[16] = {'P'};
+        for (size_t i = 0; i < arrival.size(); i++) {
+            std::string_view name = names.empty()
+                ? std::string_view(generated, std::to_chars(generated + 1, generated + sizeof(generated), first + i).ptr - generated)
+                : names[i];
+            table.add(name, arrival[i], burst[i], priority.empty() ? (int)(first + i) : priority[i]);
+        }
+    }
+    
+    // A fresh context, or the rolled-back one a resumed run carries on in
+    RunContext startRun(CheckpointLog* log) const {
+        if (log && log->from) return std::move(*log->resumeInto);
+        return RunContext(processes, recordTrace);
+    }
+    
+    // Puts a finished run back the way it was at checkpoint c, sized for the
+    // current table. Only rows finished after c, live at c or appended since
+    // are touched.
+    void rollBack(RunContext& run, const Checkpoint& c) const {
+        uint32_t n = processes.size();
+        uint32_t old = run.remainingTime.size();
+        run.remainingTime.resize(n);
+        for (uint32_t p = old; p < n; p++) run.remainingTime[p] = processes.processingTime[p];
+        run.responseTime.resize(n, 0);
+        run.turnaround.resize(n, 0);
+        run.delay.resize(n, 0);
+        run.hasStarted.resize(n, 0);
+        run.finishedProcesses.reserve(n);
+        
+        for (size_t i = c.finished; i < run.finishedProcesses.size(); i++) {
+            uint32_t p = run.finishedProcesses[i];
+            run.remainingTime[p] = processes.processingTime[p];
+            run.responseTime[p] = run.turnaround[p] = run.delay[p] = 0;
+            run.hasStarted[p] = 0;
+        }
+        run.finishedProcesses.resize(c.finished);
+        for (size_t i = 0; i < c.live.size(); i++) {
+            uint32_t p = c.live[i];
+            run.remainingTime[p] = c.remaining[i];
+            run.responseTime[p] = std::max(0, c.response[i]);
+            run.hasStarted[p] = c.response[i] >= 0;
+        }
+        run.executionOrder.rollBack(c.trace);
+        run.stats = c.stats;
+    }
+
+public:
+    // Copies a workload given as columns, one row per process. Without
+    // priorities each process gets its row index, as in the program; without
+    // names they are P0, P1, ... Arrivals must be >= 0 and bursts >= 1.
+    Status load(std::span<const int> arrival, std::span<const int> burst,
+                std::span<const int> priority = {}, std::span<const std::string_view> names = {}) {
+        Status status = checkColumns(arrival, burst, priority, names);
+        if (!status.ok()) return status;
+        
+        ProcessTable table;
+        table.reserve(arrival.size());
+        addRows(table, arrival, burst, priority, names);
+        if (table.names.chars.size() > UINT32_MAX) return {"names exceed 4 GiB"};
+        load(std::move(table), !priority.empty());
+        return {};
+    }
+    
+    // Adopts an already built table as is, such as one from generateWorkload.
+    // hasPriority says whether its priority column came from the workload.
+    // Incremental runs started before it start over from time 0 on their next
+    // resume().
+    void load(ProcessTable table, bool hasPriority = true) {
+        processes = std::move(table);
+        priorityFromInput = hasPriority;
+        sortArrivals();
+        editTimes.push_back(0);
+    }
+    
+    // Adds rows after the loaded ones, checked and defaulted as in load()
+    // (generated names and priorities continue from the current row count).
+    // Runs started earlier pick them up with resume().
+    Status append(std::span<const int> arrival, std::span<const int> burst,
+                  std::span<const int> priority = {}, std::span<const std::string_view> names = {}) {
+        Status status = checkColumns(arrival, burst, priority, names);
+        if (!status.ok()) return status;
+        if (!arrival.empty() && priority.empty() == priorityFromInput)
+            return {priorityFromInput ? "the loaded workload has priorities" : "the loaded workload has no priorities"};
+        if (processes.size() + arrival.size() >= UINT32_MAX) return {"too many processes"};
+        size_t nameBytes = processes.names.chars.size();
+        for (std::string_view name : names) nameBytes += name.size();
+        if (nameBytes + 16 * (names.empty() ? arrival.size() : 0) > UINT32_MAX) return {"names exceed 4 GiB"};
+        if (arrival.empty()) return {};
+        
+        int from = *std::min_element(arrival.begin(), arrival.end());
+        size_t position = firstArrivalFrom(from);
+        uint32_t first = processes.size();
+        addRows(processes, arrival, burst, priority, names);
+        for (uint32_t p = first; p < processes.size(); p++) arrivals.push_back(p);
+        sortArrivalsFrom(position);
+        editTimes.push_back(from);
+        return {};
+    }
+    
+    // Replaces the values of one row; see append()
+    Status update(uint32_t row, int arrival, int burst, int priority) {
+        if (row >= processes.size()) return {"row " + std::to_string(row) + " out of range"};
+        if (arrival < 0) return {"negative arrival time"};
+        if (burst < 1) return {"burst time below 1"};
+        
+        int from = std::min(arrival, processes.arrivalTime[row]);
+        size_t position = firstArrivalFrom(from);
+        processes.arrivalTime[row] = arrival;
+        processes.processingTime[row] = burst;
+        processes.priority[row] = priority;
+        sortArrivalsFrom(position);
+        editTimes.push_back(from);
+        return {};
+    }
+    
+    const ProcessTable& table() const { return processes; }
+    bool hasPriority() const { return priorityFromInput; }
+    const std::vector<uint32_t>& arrivalOrder() const { return arrivals; }
+    
+    // FNV-1a over the loaded columns; the same workload hashes equally
+    // however it was loaded
+    uint64_t workloadHash() const {
+        uint64_t h = 14695981039346656037ull;
+        auto mix = [&h](const void* data, size_t bytes) {
+            const unsigned char* p = static_cast<const unsigned char*>(data);
+            for (size_t i = 0; i < bytes; i++) h = (h ^ p[i]) * 1099511628211ull;
+        };
+        mix(processes.names.chars.data(), processes.names.chars.size());
+        mix(processes.names.offsets.data(), processes.names.offsets.size() * sizeof(uint32_t));
+        mix(processes.arrivalTime.data(), processes.size() * sizeof(int));
+        mix(processes.processingTime.data(), processes.size() * sizeof(int));
+        mix(processes.priority.data(), processes.size() * sizeof(int));
+        return h;
+    }
+    
+    Status setCfsConfig(const CfsConfig& config) {
+        if (config.targetLatency < 1 || config.minGranularity < 1) return {"CFS latency and granularity must be >= 1"};
+        cfs = config;
+        return {};
+    }
+    
+    Status setAgingConfig(const AgingConfig& config) {
+        if (config.interval < 1) return {"aging interval must be >= 1"};
+        aging = config;
+        return {};
+    }
+    
+    Status setMlfqConfig(const MlfqConfig& config) {
+        if (config.quanta.empty() || config.boostInterval < 1) return {"MLFQ needs a quantum per level and a boost interval >= 1"};
+        for (int q : config.quanta) {
+            if (q < 1) return {"MLFQ quanta must be >= 1"};
+        }
+        mlfq = config;
+        return {};
+    }
+    
+    // Off: runs leave the execution trace empty; metrics and stats are kept
+    void setRecordTrace(bool on) { recordTrace = on; }
+    
+    // 1. FCFS (First Come First Serve)
+    RunContext simulateFCFS(CheckpointLog* log = nullptr) const {
+        RunContext run = startRun(log);
+        
+        int currentTime = 0;
+        uint32_t next = 0;
+        if (log && log->from) {
+            currentTime = log->from->time;
+            next = log->from->cursor;
+        }
+        
+        for (; next < arrivals.size(); next++) {
+            if (log && log->due(currentTime)) log->save(run, currentTime, next);
+            uint32_t p = arrivals[next];
+            if (currentTime < processes.arrivalTime[p]) {
+                currentTime = processes.arrivalTime[p];
+            }
+            
+            run.responseTime[p] = currentTime - processes.arrivalTime[p];
+            run.executionOrder.append(p, currentTime, currentTime + processes.processingTime[p]);
+            currentTime += processes.processingTime[p];
+            run.finish(p, currentTime);
+        }
+        
+        return run;
+    }
+    
+    // 2. SJF (Shortest Job First)
+    RunContext simulateSJF(CheckpointLog* log = nullptr) const {
+        return simulateNonPreemptive<ShortestJobFirst>(log);
+    }
+    
+    // 3. LJF (Longest Job First)
+    RunContext simulateLJF(CheckpointLog* log = nullptr) const {
+        return simulateNonPreemptive<LongestJobFirst>(log);
+    }
+    
+    // 4. Round Robin
+    // Two shortcuts skip the quantum-by-quantum loop where its outcome is
+    // known in advance. A process alone in the queue keeps the CPU for every
+    // quantum that starts before the next arrival, so those quanta run as one
+    // step. With several processes ready, the queue order repeats after each
+    // round. Rounds that end before the next arrival and finish nobody are
+    // written straight to the trace, with no queue operations. Metrics and
+    // trace are identical to running one quantum at a time.
+    RunContext simulateRoundRobin(int timeQuantum, CheckpointLog* log = nullptr) const {
+        RunContext run = startRun(log);
+        std::deque<uint32_t> readyQueue;
+        int currentTime = 0;
+        int processIndex = 0;
+        int n = arrivals.size();
+        size_t dispatches = 0;
+        size_t nextBatchCheck = 0;  // a failed batch check waits for a full round
+        if (log && log->from) {
+            const Checkpoint& c = *log->from;
+            currentTime = c.time;
+            processIndex = c.cursor;
+            readyQueue.assign(c.live.begin(), c.live.end());
+            dispatches = c.values[0];
+            nextBatchCheck = c.values[1];
+        }
+        
+        while (processIndex < n || !readyQueue.empty()) {
+            if (log && log->due(currentTime)) {
+                Checkpoint& c = log->save(run, currentTime, processIndex);
+                for (uint32_t q : readyQueue) c.addLive(run, q);
+                c.values = {(long long)dispatches, (long long)nextBatchCheck};
+            }
+            
+            // Add newly arrived processes
+            while (processIndex < n && processes.arrivalTime[arrivals[processIndex]] <= currentTime) {
+                readyQueue.push_back(arrivals[processIndex]);
+                processIndex++;
+            }
+            
+            if (readyQueue.empty()) {
+                if (processIndex < n) {
+                    currentTime = processes.arrivalTime[arrivals[processIndex]];
+                }
+                continue;
+            }
+            
+            long long nextArrival = processIndex < n ? processes.arrivalTime[arrivals[processIndex]] : LLONG_MAX;
+            if (readyQueue.size() > 1 && dispatches >= nextBatchCheck) {
+                // Whole rounds that end before the next arrival and leave
+                // every process with work to do
+                long long roundLength = (long long)readyQueue.size() * timeQuantum;
+                long long rounds = (nextArrival - 1 - currentTime) / roundLength;
+                for (uint32_t q : readyQueue) {
+                    if (rounds <= 0) break;
+                    rounds = std::min<long long>(rounds, (run.remainingTime[q] - 1) / timeQuantum);
+                }
+                if (rounds > 0) {
+                    for (long long r = 0; r < rounds; r++) {
+                        for (uint32_t q : readyQueue) {
+                            if (!run.hasStarted[q]) {
+                                run.responseTime[q] = currentTime - processes.arrivalTime[q];
+                                run.hasStarted[q] = 1;
+                            }
+                            run.executionOrder.append(q, currentTime, currentTime + timeQuantum);
+                            currentTime += timeQuantum;
+                        }
+                    }
+                    for (uint32_t q : readyQueue) run.remainingTime[q] -= rounds * timeQuantum;
+                    dispatches += rounds * readyQueue.size();
+                    continue;
+                }
+                nextBatchCheck = dispatches + readyQueue.size();
+            }
+            
+            uint32_t p = readyQueue.front();
+            readyQueue.pop_front();
+            dispatches++;
+            
+            if (!run.hasStarted[p]) {
+                run.responseTime[p] = currentTime - processes.arrivalTime[p];
+                run.hasStarted[p] = 1;
+            }
+            
+            long long quanta = 1;
+            if (readyQueue.empty()) {
+                // Alone: every quantum that starts before the next arrival
+                quanta = (run.remainingTime[p] + timeQuantum - 1) / timeQuantum;
+                if (nextArrival != LLONG_MAX)
+                    quanta = std::min(quanta, (nextArrival - currentTime + timeQuantum - 1) / timeQuantum);
+                quanta = std::max(1LL, quanta);
+            }
+            int execTime = std::min<long long>(quanta * timeQuantum, run.remainingTime[p]);
+            run.executionOrder.append(p, currentTime, currentTime + execTime, quanta);
+            currentTime += execTime;
+            run.remainingTime[p] -= execTime;
+            
+            // Add newly arrived processes before re-queueing current process
+            while (processIndex < n && processes.arrivalTime[arrivals[processIndex]] <= currentTime) {
+                readyQueue.push_back(arrivals[processIndex]);
+                processIndex++;
+            }
+            
+            if (run.remainingTime[p] > 0) {
+                readyQueue.push_back(p);
+            } else {
+                run.finish(p, currentTime);
+            }
+        }
+        
+        return run;
+    }
+    
+    // 5. Priority Scheduling (Non-preemptive)
+    RunContext simulatePriority(CheckpointLog* log = nullptr) const {
+        return simulateNonPreemptive<HighestPriorityFirst>(log);
+    }
+    
+    // 6. SRTF (Shortest Remaining Time First - Preemptive SJF)
+    // Event driven: the running process can only be overtaken when something
+    // arrives, so each dispatch runs it until the next arrival or its
+    // completion, whichever is first. Ready processes sit in a heap ordered
+    // by RunContext::compareSRTF (then input line), which is the same choice
+    // the per-tick scan made, at O((n + preemptions) log n) instead of
+    // O(total burst * n).
+    RunContext simulateSRTF(CheckpointLog* log = nullptr) const {
+        RunContext run = startRun(log);
+        int n = arrivals.size();
+        
+        // A process's key only changes while it is out of the heap running
+        auto runsAfter = [&run](uint32_t a, uint32_t b) {
+            if (RunContext::compareSRTF(run, b, a)) return true;
+            if (RunContext::compareSRTF(run, a, b)) return false;
+            return b < a;
+        };
+        std::vector<uint32_t> heapStorage;
+        heapStorage.reserve(n);
+        ReadyHeap<decltype(runsAfter)> readyQueue(runsAfter, std::move(heapStorage));
+        int nextArrival = 0;
+        int currentTime = 0;
+        if (log && log->from) {
+            currentTime = log->from->time;
+            nextArrival = log->from->cursor;
+            for (uint32_t p : log->from->live) readyQueue.push(p);
+        }
+        
+        while (nextArrival < n || !readyQueue.empty()) {
+            if (log && log->due(currentTime)) {
+                Checkpoint& c = log->save(run, currentTime, nextArrival);
+                for (uint32_t p : readyQueue.items()) c.addLive(run, p);
+            }
+            
+            while (nextArrival < n && processes.arrivalTime[arrivals[nextArrival]] <= currentTime)
+                readyQueue.push(arrivals[nextArrival++]);
+            
+            if (readyQueue.empty()) {
+                currentTime = processes.arrivalTime[arrivals[nextArrival]];
+                continue;
+            }
+            
+            uint32_t p = readyQueue.top();
+            readyQueue.pop();
+            
+            if (!run.hasStarted[p]) {
+                run.responseTime[p] = currentTime - processes.arrivalTime[p];
+                run.hasStarted[p] = 1;
+            }
+            
+            int slice = run.remainingTime[p];
+            if (nextArrival < n)
+                slice = std::min(slice, processes.arrivalTime[arrivals[nextArrival]] - currentTime);
+            run.executionOrder.append(p, currentTime, currentTime + slice, slice);
+            run.remainingTime[p] -= slice;
+            currentTime += slice;
+            
+            if (run.remainingTime[p] == 0) {
+                run.finish(p, currentTime);
+            } else {
+                readyQueue.push(p);
+            }
+        }
+        
+        return run;
+    }
+    
+    // 7. CFS (Completely Fair Scheduler)
+    // Runnable processes sit in a red-black tree (std::set) ordered by virtual
+    // runtime. The leftmost one runs for its weighted share of the scheduling
+    // period, max(targetLatency, runnable * minGranularity), then goes back in
+    // with its vruntime advanced by the time it ran times NICE_0_WEIGHT /
+    // weight. The priority column is the nice value, clamped to -20..19; a
+    // workload without priorities runs everything at nice 0.
+    // Newcomers start at the minimum vruntime so they neither starve nor get
+    // starved. Preemption happens at slice ends only, not on wakeup.
+    RunContext simulateCFS(CheckpointLog* log = nullptr) const {
+        RunContext run = startRun(log);
+        int n = arrivals.size();
+        
+        // vruntime is kept in 1/1024ths of a tick so heavy weights still advance
+        const long long VRUNTIME_SCALE = 1024;
+        auto weightOf = [this](uint32_t p) {
+            if (!priorityFromInput) return NICE_0_WEIGHT;
+            return NICE_TO_WEIGHT[std::clamp(processes.priority[p], -20, 19) + 20];
+        };
+        std::vector<long long> vruntime(n, 0);
+        std::set<std::pair<long long, uint32_t>> tree;
+        long long totalWeight = 0;
+        long long minVruntime = 0;
+        int nextArrival = 0;
+        int currentTime = 0;
+        if (log && log->from) {
+            const Checkpoint& c = *log->from;
+            currentTime = c.time;
+            nextArrival = c.cursor;
+            for (size_t i = 0; i < c.live.size(); i++) {
+                vruntime[c.live[i]] = c.extra[i];
+                tree.insert({c.extra[i], c.live[i]});
+            }
+            totalWeight = c.values[0];
+            minVruntime = c.values[1];
+        }
+        
+        while (nextArrival < n || !tree.empty()) {
+            if (log && log->due(currentTime)) {
+                Checkpoint& c = log->save(run, currentTime, nextArrival);
+                for (const auto& [v, p] : tree) {
+                    c.addLive(run, p);
+                    c.extra.push_back(v);
+                }
+                c.values = {totalWeight, minVruntime};
+            }
+            
+            while (nextArrival < n && processes.arrivalTime[arrivals[nextArrival]] <= currentTime) {
+                uint32_t p = arrivals[nextArrival++];
+                vruntime[p] = minVruntime;
+                tree.insert({vruntime[p], p});
+                totalWeight += weightOf(p);
+            }
+            
+            if (tree.empty()) {
+                currentTime = processes.arrivalTime[arrivals[nextArrival]];
+                continue;
+            }
+            
+            uint32_t p = tree.begin()->second;
+            tree.erase(tree.begin());
+            
+            if (!run.hasStarted[p]) {
+                run.responseTime[p] = currentTime - processes.arrivalTime[p];
+                run.hasStarted[p] = 1;
+            }
+            
+            long long period = std::max<long long>(cfs.targetLatency, (long long)(tree.size() + 1) * cfs.minGranularity);
+            long long share = std::max<long long>(cfs.minGranularity, period * weightOf(p) / totalWeight);
+            int slice = std::max<long long>(1, std::min<long long>(share, run.remainingTime[p]));
+            run.executionOrder.append(p, currentTime, currentTime + slice);
+            run.remainingTime[p] -= slice;
+            currentTime += slice;
+            vruntime[p] += slice * NICE_0_WEIGHT * VRUNTIME_SCALE / weightOf(p);
+            
+            if (run.remainingTime[p] == 0) {
+                run.finish(p, currentTime);
+                totalWeight -= weightOf(p);
+            } else {
+                tree.insert({vruntime[p], p});
+            }
+            if (!tree.empty()) minVruntime = std::max(minVruntime, tree.begin()->first);
+        }
+        
+        return run;
+    }
+    
+    // 8. Preemptive Priority with aging
+    // A process that has waited w ticks since it last became ready has the
+    // effective priority base - w / aging.interval (integer division). All
+    // waiting processes age at the same rate, so their relative order never
+    // changes: sorting by S = base * interval + readyTime sorts them by
+    // effective priority at every instant, with S then arrival then row
+    // breaking ties. No key is ever updated. A running process keeps the
+    // priority it was dispatched with and starts again from its base priority
+    // when it goes back to the ready set. The moment the best waiting
+    // process overtakes it is computed directly, so the loop only stops at
+    // arrivals, completions and preemptions.
+    RunContext simulatePriorityAging(CheckpointLog* log = nullptr) const {
+        RunContext run = startRun(log);
+        uint32_t n = arrivals.size();
+        const uint32_t NONE = UINT32_MAX;
+        const long long interval = std::max(1, aging.interval);
+        
+        std::vector<long long> agingKey(n, 0);  // S
+        auto runsAfter = [&](uint32_t a, uint32_t b) {
+            if (agingKey[a] != agingKey[b]) return agingKey[a] > agingKey[b];
+            if (processes.arrivalTime[a] != processes.arrivalTime[b])
+                return processes.arrivalTime[a] > processes.arrivalTime[b];
+            return a > b;
+        };
+        std::vector<uint32_t> heapStorage;
+        heapStorage.reserve(n);
+        ReadyHeap<decltype(runsAfter)> readyQueue(runsAfter, std::move(heapStorage));
+        
+        uint32_t nextArrival = 0;
+        uint32_t running = NONE;
+        long long runningPriority = 0;
+        int sliceStart = 0;
+        int currentTime = 0;
+        
+        auto makeReady = [&](uint32_t p) {
+            agingKey[p] = processes.priority[p] * interval + currentTime;
+            readyQueue.push(p);
+        };
+        auto stopRunning = [&] {
+            run.executionOrder.append(running, sliceStart, currentTime);
+            uint32_t p = running;
+            running = NONE;
+            if (run.remainingTime[p] == 0) {
+                run.finish(p, currentTime);
+            } else {
+                makeReady(p);
+            }
+        };
+        // Effective priority of a waiting process is ceil((S - t) / interval);
+        // it drops below `priority` from t = S - interval * (priority - 1) on
+        auto overtakesAt = [&](uint32_t p, long long priority) {
+            return agingKey[p] - interval * (priority - 1);
+        };
+        
+        // The running process, if any, is the first live one
+        if (log && log->from) {
+            const Checkpoint& c = *log->from;
+            currentTime = c.time;
+            nextArrival = c.cursor;
+            running = c.values[0];
+            runningPriority = c.values[1];
+            sliceStart = c.values[2];
+            for (size_t i = running == NONE ? 0 : 1; i < c.live.size(); i++) {
+                agingKey[c.live[i]] = c.extra[i];
+                readyQueue.push(c.live[i]);
+            }
+        }
+        
+        while (run.finishedProcesses.size() < n) {
+            if (log && log->due(currentTime)) {
+                Checkpoint& c = log->save(run, currentTime, nextArrival);
+                if (running != NONE) {
+                    c.addLive(run, running);
+                    c.extra.push_back(0);
+                }
+                for (uint32_t p : readyQueue.items()) {
+                    c.addLive(run, p);
+                    c.extra.push_back(agingKey[p]);
+                }
+                c.values = {running, runningPriority, sliceStart};
+            }
+            
+            while (nextArrival < n && processes.arrivalTime[arrivals[nextArrival]] <= currentTime)
+                makeReady(arrivals[nextArrival++]);
+            
+            if (running != NONE && !readyQueue.empty() && overtakesAt(readyQueue.top(), runningPriority) <= currentTime)
+                stopRunning();
+            
+            if (running == NONE) {
+                if (readyQueue.empty()) {
+                    currentTime = processes.arrivalTime[arrivals[nextArrival]];
+                    continue;
+                }
+                running = readyQueue.top();
+                readyQueue.pop();
+                long long waited = currentTime - (agingKey[running] - processes.priority[running] * interval);
+                runningPriority = processes.priority[running] - waited / interval;
+                sliceStart = currentTime;
+                if (!run.hasStarted[running]) {
+                    run.responseTime[running] = currentTime - processes.arrivalTime[running];
+                    run.hasStarted[running] = 1;
+                }
+            }
+            
+            // Run until completion, the next arrival or being overtaken
+            long long nextEvent = currentTime + run.remainingTime[running];
+            if (nextArrival < n) nextEvent = std::min<long long>(nextEvent, processes.arrivalTime[arrivals[nextArrival]]);
+            if (!readyQueue.empty()) nextEvent = std::min(nextEvent, overtakesAt(readyQueue.top(), runningPriority));
+            run.remainingTime[running] -= nextEvent - currentTime;
+            currentTime = nextEvent;
+            if (run.remainingTime[running] == 0) stopRunning();
+        }
+        
+        return run;
+    }
+    
+    // 9. MLFQ (Multi-Level Feedback Queue)
+    // mlfq.quanta[l] is the time slice at level l and new processes enter
+    // level 0. A process that uses its whole slice drops a level (down to the
+    // last one). A process preempted by a higher-level arrival keeps its level
+    // and goes to the back of it. Every boostInterval ticks all processes
+    // return to level 0. Each level is a FIFO of processes stamped with an
+    // enqueue sequence number. A boost only records the current sequence
+    // number: anything stamped earlier counts as level 0 and is served in
+    // stamp order, which is the oldest head among the levels. A boost is
+    // O(1) and a pick is O(levels).
+    RunContext simulateMLFQ(CheckpointLog* log = nullptr) const {
+        RunContext run = startRun(log);
+        uint32_t n = arrivals.size();
+        const uint32_t NONE = UINT32_MAX;
+        const int levels = std::max<int>(1, mlfq.quanta.size());
+        auto quantumAt = [&](int level) { return mlfq.quanta.empty() ? 1 : std::max(1, mlfq.quanta[level]); };
+        
+        std::vector<int> level(n, 0);
+        std::vector<uint64_t> enqueued(n, 0);
+        std::vector<std::deque<uint32_t>> queues(levels);
+        uint64_t sequence = 0;
+        uint64_t boosted = 0;  // stamps below this were waiting at the last boost
+        size_t waiting = 0;
+        
+        uint32_t nextArrival = 0;
+        uint32_t running = NONE;
+        int sliceStart = 0;
+        int sliceEnd = 0;
+        int currentTime = 0;
+        int boostInterval = std::max(1, mlfq.boostInterval);
+        int nextBoost = boostInterval;
+        
+        auto makeReady = [&](uint32_t p) {
+            enqueued[p] = sequence++;
+            queues[level[p]].push_back(p);
+            waiting++;
+        };
+        // Level the next pick would run at, and the queue it comes from
+        auto best = [&](int& fromQueue) {
+            int oldest = -1;
+            fromQueue = -1;
+            for (int l = 0; l < levels; l++) {
+                if (queues[l].empty()) continue;
+                if (fromQueue < 0) fromQueue = l;
+                if (oldest < 0 || enqueued[queues[l].front()] < enqueued[queues[oldest].front()]) oldest = l;
+            }
+            if (oldest >= 0 && enqueued[queues[oldest].front()] < boosted) {
+                fromQueue = oldest;
+                return 0;
+            }
+            return fromQueue;
+        };
+        auto stopRunning = [&](bool demote) {
+            run.executionOrder.append(running, sliceStart, currentTime);
+            uint32_t p = running;
+            running = NONE;
+            if (run.remainingTime[p] == 0) {
+                run.finish(p, currentTime);
+            } else {
+                if (demote) level[p] = std::min(level[p] + 1, levels - 1);
+                makeReady(p);
+            }
+        };
+        
+        // The running process, if any, is the first live one; each live
+        // process carries its level and enqueue stamp
+        if (log && log->from) {
+            const Checkpoint& c = *log->from;
+            currentTime = c.time;
+            nextArrival = c.cursor;
+            running = c.values[0];
+            sliceStart = c.values[1];
+            sliceEnd = c.values[2];
+            nextBoost = c.values[3];
+            sequence = c.values[4];
+            boosted = c.values[5];
+            waiting = c.values[6];
+            for (size_t i = 0; i < c.live.size(); i++) {
+                uint32_t p = c.live[i];
+                level[p] = c.extra[2 * i];
+                enqueued[p] = c.extra[2 * i + 1];
+                if (p != running) queues[level[p]].push_back(p);
+            }
+        }
+        
+        while (run.finishedProcesses.size() < n) {
+            if (log && log->due(currentTime)) {
+                Checkpoint& c = log->save(run, currentTime, nextArrival);
+                auto add = [&](uint32_t p) {
+                    c.addLive(run, p);
+                    c.extra.push_back(level[p]);
+                    c.extra.push_back(enqueued[p]);
+                };
+                if (running != NONE) add(running);
+                for (const auto& queue : queues) {
+                    for (uint32_t p : queue) add(p);
+                }
+                c.values = {running, sliceStart, sliceEnd, nextBoost, (long long)sequence, (long long)boosted, (long long)waiting};
+            }
+            
+            while (nextArrival < n && processes.arrivalTime[arrivals[nextArrival]] <= currentTime)
+                makeReady(arrivals[nextArrival++]);
+            
+            if (currentTime >= nextBoost) {
+                boosted = sequence;
+                if (running != NONE) level[running] = 0;
+                nextBoost = (currentTime / boostInterval + 1) * boostInterval;
+            }
+            
+            int fromQueue;
+            int topLevel = waiting ? best(fromQueue) : 0;
+            if (running != NONE && currentTime == sliceEnd) {
+                stopRunning(true);
+            } else if (running != NONE && waiting && topLevel < level[running]) {
+                stopRunning(false);
+            }
+            
+            if (running == NONE) {
+                if (!waiting) {
+                    currentTime = processes.arrivalTime[arrivals[nextArrival]];
+                    nextBoost = std::max(nextBoost, (currentTime / boostInterval) * boostInterval);
+                    continue;
+                }
+                int pickLevel = best(fromQueue);
+                running = queues[fromQueue].front();
+                queues[fromQueue].pop_front();
+                level[running] = pickLevel;
+                waiting--;
+                sliceStart = currentTime;
+                sliceEnd = currentTime + std::min(quantumAt(level[running]), run.remainingTime[running]);
+                if (!run.hasStarted[running]) {
+                    run.responseTime[running] = currentTime - processes.arrivalTime[running];
+                    run.hasStarted[running] = 1;
+                }
+            }
+            
+            // Run until the slice ends, the next arrival or the next boost
+            int nextEvent = std::min(sliceEnd, nextBoost);
+            if (nextArrival < n) nextEvent = std::min(nextEvent, processes.arrivalTime[arrivals[nextArrival]]);
+            run.remainingTime[running] -= nextEvent - currentTime;
+            currentTime = nextEvent;
+            if (run.remainingTime[running] == 0) stopRunning(false);
+        }
+        
+        return run;
+    }
+    
+    // Shared loop of SJF, LJF and Priority, instantiated once per ready-queue
+    // order (see ShortestJobFirst and friends) so the comparison is inlined
+    // into the heap. Ties go to the earlier line of the input file, and
+    // arrivals are taken from a cursor over the processes sorted by arrival
+    // time, so every dispatch costs O(log n).
+    //
+    // When nothing is ready the clock jumps to the arrival time of the first
+    // process *in file order* that has not arrived yet, as it always has; for
+    // inputs not sorted by arrival this can skip past earlier arrivals.
+    template <class Order>
+    RunContext simulateNonPreemptive(CheckpointLog* log = nullptr) const {
+        RunContext run = startRun(log);
+        int n = arrivals.size();
+        
+        // Heap order: `a` sinks below `b` when b must run first
+        auto runsAfter = [this](uint32_t a, uint32_t b) {
+            if (Order::before(processes, b, a)) return true;
+            if (Order::before(processes, a, b)) return false;
+            return b < a;
+        };
+        std::vector<uint32_t> heapStorage;
+        heapStorage.reserve(n);
+        ReadyHeap<decltype(runsAfter)> readyQueue(runsAfter, std::move(heapStorage));
+        int nextArrival = 0;   // cursor into arrivals
+        int firstPending = 0;  // first not-yet-arrived process in file order
+        int currentTime = 0;
+        if (log && log->from) {
+            currentTime = log->from->time;
+            nextArrival = log->from->cursor;
+            firstPending = log->from->values[0];
+            for (uint32_t p : log->from->live) readyQueue.push(p);
+        }
+        
+        while (nextArrival < n || !readyQueue.empty()) {
+            if (log && log->due(currentTime)) {
+                Checkpoint& c = log->save(run, currentTime, nextArrival);
+                for (uint32_t p : readyQueue.items()) c.addLive(run, p);
+                c.values = {firstPending};
+            }
+            
+            while (nextArrival < n && processes.arrivalTime[arrivals[nextArrival]] <= currentTime)
+                readyQueue.push(arrivals[nextArrival++]);
+            
+            // Everything arriving by now has been pushed, so a process has
+            // arrived exactly when its arrival time is not in the future
+            if (readyQueue.empty()) {
+                while (processes.arrivalTime[firstPending] <= currentTime) firstPending++;
+                currentTime = processes.arrivalTime[firstPending];
+                continue;
+            }
+            
+            uint32_t p = readyQueue.top();
+            readyQueue.pop();
+            
+            run.responseTime[p] = std::max(0, currentTime - processes.arrivalTime[p]);
+            int endTime = currentTime + processes.processingTime[p];
+            run.executionOrder.append(p, currentTime, endTime);
+            currentTime = endTime;
+            run.finish(p, currentTime);
+        }
+        
+        return run;
+    }
+    
+    RunContext simulate(Policy policy, int timeQuantum = 2, CheckpointLog* log = nullptr) const {
+        switch (policy) {
+            case Policy::FCFS: return simulateFCFS(log);
+            case Policy::SJF: return simulateSJF(log);
+            case Policy::LJF: return simulateLJF(log);
+            case Policy::RoundRobin: return simulateRoundRobin(timeQuantum, log);
+            case Policy::Priority: return simulatePriority(log);
+            case Policy::SRTF: return simulateSRTF(log);
+            case Policy::CFS: return simulateCFS(log);
+            case Policy::PriorityAging: return simulatePriorityAging(log);
+            default: return simulateMLFQ(log);
+        }
+    }
+    
+    // Runs one policy into plain arrays
+    Status run(Policy policy, SimulationResult& result, int timeQuantum = 2) const {
+        if ((int)policy < 0 || (int)policy >= POLICY_COUNT) return {"unknown policy"};
+        if (timeQuantum < 1) return {"time quantum must be >= 1"};
+        RunContext context = simulate(policy, timeQuantum);
+        result.responseTime = std::move(context.responseTime);
+        result.turnaround = std::move(context.turnaround);
+        result.delay = std::move(context.delay);
+        result.completionOrder = std::move(context.finishedProcesses);
+        result.trace = context.executionOrder.release();
+        result.stats = context.stats;
+        return {};
+    }
+    
+    // Runs one policy like simulate() and keeps it in `inc` with a
+    // checkpoint every checkpointInterval ticks of simulated time, for
+    // resume() to start from later. Memory per checkpoint is proportional to
+    // the processes live at that moment, and inc.log.budget caps the total.
+    Status runIncremental(Policy policy, int checkpointInterval, IncrementalRun& inc, int timeQuantum = 2) const {
+        if ((int)policy < 0 || (int)policy >= POLICY_COUNT) return {"unknown policy"};
+        if (timeQuantum < 1) return {"time quantum must be >= 1"};
+        if (checkpointInterval < 1) return {"checkpoint interval must be >= 1"};
+        inc.policy = policy;
+        inc.timeQuantum = timeQuantum;
+        inc.version = editTimes.size();
+        inc.resumedAt = -1;
+        inc.log.interval = checkpointInterval;
+        inc.log.nextAt = 0;
+        inc.log.saved.clear();
+        inc.log.savedBytes = 0;
+        inc.context = std::make_unique<RunContext>(simulate(policy, timeQuantum, &inc.log));
+        return {};
+    }
+    
+    // Brings `inc` up to date with the edits made since it last ran. The
+    // result equals a fresh run of the edited workload, but only the part
+    // after the latest checkpoint taken before the earliest edited arrival is
+    // simulated again. The configs must not have changed in between.
+    Status resume(IncrementalRun& inc) const {
+        if (!inc.context) return {"run was never started"};
+        if (inc.version == editTimes.size()) return {};
+        int from = *std::min_element(editTimes.begin() + inc.version, editTimes.end());
+        inc.version = editTimes.size();
+        
+        CheckpointLog& log = inc.log;
+        auto valid = std::partition_point(log.saved.begin(), log.saved.end(), [from](const Checkpoint& c) {
+            return c.time < from;
+        });
+        log.saved.erase(valid, log.saved.end());
+        log.countBytes();
+        if (log.saved.empty()) {
+            inc.resumedAt = -1;
+            log.nextAt = 0;
+            inc.context = std::make_unique<RunContext>(simulate(inc.policy, inc.timeQuantum, &log));
+            return {};
+        }
+        
+        const Checkpoint& c = log.saved.back();
+        rollBack(*inc.context, c);
+        inc.resumedAt = c.time;
+        log.nextAt = (long long)c.time + log.interval;
+        log.from = &c;  // saving more checkpoints may move it, so engines read it only up front
+        log.resumeInto = inc.context.get();
+        RunContext resumed = simulate(inc.policy, inc.timeQuantum, &log);
+        log.from = nullptr;
+        log.resumeInto = nullptr;
+        inc.context = std::make_unique<RunContext>(std::move(resumed));
+        return {};
+    }
+    
+    // The parameters a policy's result depends on, as a compact label
+    std::string describeParams(Policy policy, int timeQuantum) const {
+        switch (policy) {
+            case Policy::RoundRobin: return std::to_string(timeQuantum);
+            case Policy::CFS: return std::to_string(cfs.targetLatency) + "/" + std::to_string(cfs.minGranularity);
+            case Policy::PriorityAging: return std::to_string(aging.interval);
+            case Policy::MLFQ: {
+                std::string label;
+                for (int q : mlfq.quanta) label += (label.empty() ? "" : ":") + std::to_string(q);
+                return label + "/" + std::to_string(mlfq.boostInterval);
+            }
+            default: return "";
+        }
+    }
+};
+
+} // namespace cpusched
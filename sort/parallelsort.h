@@ -0,0 +1,769 @@
+/************************************************************************
+ * Parallel sort library (header-only)
+ * Algorithms: Merge Sort, Quick Sort, Heap Sort, Radix Sort, Bitonic Sort
+ *
+ * The sorting kernels shared by the safe program and by embedders. Nothing
+ * in here touches files or global state: psort::Sorter sorts a caller-owned
+ * span in place, returns the threshold counts in a SortResult, and keeps its
+ * worker threads alive between calls. Sorter::sort may be called from
+ * several threads at once. Spans are indexed with int, so N < INT_MAX.
+ *
+ * Cutoffs, radix digit width and parallel granularity come from a
+ * SortTuning; autoTune() measures the host and saveProfile()/loadProfile()
+ * persist the result.
+*************************************************************************/
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <random>
+#include <span>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+namespace psort {
+
+/************************************************************************
+ * THREAD POOL
+*************************************************************************/
+// Fixed set of workers fed from one FIFO. Callers that wait on a TaskGroup
+// run queued tasks themselves and sleep when there are none, so nested
+// parallel recursion cannot deadlock the pool even when every worker is
+// blocked in a wait.
+class ThreadPool {
+public:
+	explicit ThreadPool(unsigned workerCount) {
+		for (unsigned i = 0; i < workerCount; i++)
+			workers.emplace_back([this] { workerLoop(); });
+	}
+
+	~ThreadPool() {
+		{
+			std::lock_guard<std::mutex> lock(mtx);
+			stopping = true;
+		}
+		cv.notify_all();
+		for (auto& t : workers) t.join();
+	}
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	void submit(std::function<void()> task) {
+		{
+			std::lock_guard<std::mutex> lock(mtx);
+			tasks.push_back(std::move(task));
+		}
+		cv.notify_one();
+	}
+
+	// Run queued tasks on the calling thread until done() holds, sleeping
+	// while the queue is empty. Whatever makes done() true must call wake().
+	template <class Done>
+	void helpUntil(Done done) {
+		for (;;) {
+			std::function<void()> task;
+			{
+				std::unique_lock<std::mutex> lock(mtx);
+				cv.wait(lock, [&] { return done() || !tasks.empty(); });
+				if (done()) return;
+				task = std::move(tasks.front());
+				tasks.pop_front();
+			}
+			task();
+		}
+	}
+
+	void wake() {
+		{
+			std::lock_guard<std::mutex> lock(mtx);
+		}
+		cv.notify_all();
+	}
+
+	// Threads that execute work: the workers plus the calling thread.
+	unsigned concurrency() const { return workers.size() + 1; }
+
+private:
+	void workerLoop() {
+		for (;;) {
+			std::function<void()> task;
+			{
+				std::unique_lock<std::mutex> lock(mtx);
+				cv.wait(lock, [this] { return stopping || !tasks.empty(); });
+				if (tasks.empty()) return;
+				task = std::move(tasks.front());
+				tasks.pop_front();
+			}
+			task();
+		}
+	}
+
+	std::vector<std::thread> workers;
+	std::deque<std::function<void()>> tasks;
+	std::mutex mtx;
+	std::condition_variable cv;
+	bool stopping = false;
+};
+
+// Fork/join scope over a pool. Without a pool, run() executes inline.
+class TaskGroup {
+public:
+	explicit TaskGroup(ThreadPool* pool) : pool(pool) {}
+	~TaskGroup() { wait(); }
+
+	void run(std::function<void()> task) {
+		if (!pool) {
+			task();
+			return;
+		}
+		pending++;
+		// The group may be gone once pending reaches 0, so keep the pool here
+		pool->submit([this, pool = pool, task = std::move(task)] {
+			task();
+			if (--pending == 0) pool->wake();
+		});
+	}
+
+	void wait() {
+		if (pool) pool->helpUntil([this] { return pending == 0; });
+	}
+
+private:
+	ThreadPool* pool;
+	std::atomic<int> pending{0};
+};
+
+/************************************************************************
+ * TUNING
+*************************************************************************/
+enum class Algorithm { Merge, Quick, Heap, Radix, Bitonic };
+const int ALGORITHM_COUNT = 5;
+
+// Knobs that used to be hardcoded. The defaults reproduce the original
+// behaviour except for radixBits, which replaces the base-10 digits.
+struct SortTuning {
+	int mergeCutoff = 0;       // merge ranges of at most this many elements are insertion sorted
+	int quickCutoff = 0;       // same for quick sort; 0 disables both
+	int quickSpawnDepth = 2;   // quickSort forks its halves while depth < this
+	int quickForkMin = 0;      // ...and the range holds at least this many elements
+	int quickPartitionMin = 1 << 16; // forking levels this large partition in parallel
+	int quickStartDepth = 2;   // depth the program's per-thread quick sorts start at
+	int radixBits = 8;         // radix digit width in bits (1..16)
+	int chunks[ALGORITHM_COUNT] = {0, 0, 0, 0, 0}; // Sorter chunks per call; 0 = one per thread
+};
+
+inline void insertionSort(int arr[], int low, int high) {
+	for (int i = low + 1; i <= high; i++) {
+		int key = arr[i];
+		int j = i - 1;
+		while (j >= low && arr[j] > key) {
+			arr[j + 1] = arr[j];
+			j--;
+		}
+		arr[j + 1] = key;
+	}
+}
+
+/************************************************************************
+ * MERGE SORT FUNCTIONS
+*************************************************************************/
+inline void mergeH(int arrayA[], int LMIndex, int MidIndex, int RMIndex)
+{
+	int leftArraySize = MidIndex - LMIndex + 1;
+	int rightArraySize = RMIndex - MidIndex;
+	int* leftArray = new int[leftArraySize];
+	int* rightArray = new int[rightArraySize];
+	for (int i = 0; i < leftArraySize; i++)	leftArray[i] = arrayA[LMIndex + i];
+	for (int j = 0; j < rightArraySize; j++) rightArray[j] = arrayA[MidIndex + 1 + j];
+	int i = 0;
+	int j = 0;
+	int index = LMIndex;
+	while (i < leftArraySize && j < rightArraySize)
+		arrayA[index++] = (leftArray[i] <= rightArray[j]) ? leftArray[i++] : rightArray[j++];
+	while (i < leftArraySize) arrayA[index++] = leftArray[i++];
+	while (j < rightArraySize) arrayA[index++] = rightArray[j++];
+	delete[] leftArray;
+	delete[] rightArray;
+}
+
+inline void mergeSort(int arrayA[], int LMIndex, int RMIndex, const SortTuning& tuning = SortTuning()) {
+	if (LMIndex >= RMIndex) return;
+	if (RMIndex - LMIndex < tuning.mergeCutoff) {
+		insertionSort(arrayA, LMIndex, RMIndex);
+		return;
+	}
+	int MidIndex = LMIndex + (RMIndex - LMIndex) / 2;
+	mergeSort(arrayA, LMIndex, MidIndex, tuning);
+	mergeSort(arrayA, MidIndex + 1, RMIndex, tuning);
+	mergeH(arrayA, LMIndex, MidIndex, RMIndex);
+}
+
+/************************************************************************
+ * QUICK SORT FUNCTIONS
+*************************************************************************/
+inline int partition(int arr[], int low, int high) {
+	int pivot = arr[high];
+	int i = low - 1;
+	for (int j = low; j < high; j++) {
+		if (arr[j] <= pivot) {
+			i++;
+			std::swap(arr[i], arr[j]);
+		}
+	}
+	std::swap(arr[i + 1], arr[high]);
+	return i + 1;
+}
+
+// Move the median of arr[low], arr[mid], arr[high] to arr[high] so that
+// partition() does not degrade to O(n^2) on already-sorted input.
+inline void medianToHigh(int arr[], int low, int high) {
+	int mid = low + (high - low) / 2;
+	if (arr[mid] < arr[low]) std::swap(arr[mid], arr[low]);
+	if (arr[high] < arr[low]) std::swap(arr[high], arr[low]);
+	if (arr[mid] < arr[high]) std::swap(arr[mid], arr[high]);
+}
+
+// partition() leaves keys equal to the pivot scattered on its left side.
+// Gather them next to the pivot and return where that run starts, so inputs
+// with many duplicates still shrink on every step.
+inline int equalRunStart(int arr[], int low, int pi) {
+	int pivot = arr[pi];
+	return std::partition(arr + low, arr + pi, [pivot](int x) { return x < pivot; }) - arr;
+}
+
+// Parallel split of [low, high): moves the elements matching
+// pred to the front and returns where the rest starts. Each block is split
+// on its own, which leaves every block as [match | rest]. Counting the
+// matches gives the split point p; the only misplaced elements are then the
+// non-matching ones left of p and the matching ones right of p, and there
+// are equally many of each. The cleanup pairs them up and swaps them in
+// parallel.
+template <class Pred>
+int parallelSplit(int arr[], int low, int high, ThreadPool* pool, int blocks, Pred pred) {
+	int n = high - low;
+	blocks = std::max(1, std::min(blocks, n / 4096));
+	int blockSize = n / blocks;
+	std::vector<int> begin(blocks), mid(blocks), end(blocks);
+
+	{
+		TaskGroup group(pool);
+		for (int b = 0; b < blocks; b++) {
+			begin[b] = low + b * blockSize;
+			end[b] = (b == blocks - 1) ? high : begin[b] + blockSize;
+			group.run([=, &begin, &mid, &end] {
+				int i = begin[b];
+				for (int j = begin[b]; j < end[b]; j++)
+					if (pred(arr[j])) std::swap(arr[i++], arr[j]);
+				mid[b] = i;
+			});
+		}
+	}
+
+	int p = low;
+	for (int b = 0; b < blocks; b++) p += mid[b] - begin[b];
+
+	// Misplaced runs, in address order: non-matching elements in [low, p)
+	// and matching elements in [p, high)
+	struct Run { int first, last; };
+	std::vector<Run> large, small;
+	for (int b = 0; b < blocks; b++) {
+		if (mid[b] < p) large.push_back({mid[b], std::min(end[b], p)});
+		if (mid[b] > p) small.push_back({std::max(begin[b], p), mid[b]});
+	}
+	auto prefixOf = [](const std::vector<Run>& runs) {
+		std::vector<int> prefix(runs.size() + 1, 0);
+		for (size_t r = 0; r < runs.size(); r++) prefix[r + 1] = prefix[r] + runs[r].last - runs[r].first;
+		return prefix;
+	};
+	std::vector<int> largePrefix = prefixOf(large), smallPrefix = prefixOf(small);
+	int misplaced = largePrefix.back();
+
+	// Address of the k-th element of a run list
+	auto locate = [](const std::vector<Run>& runs, const std::vector<int>& prefix, int k, size_t& r) {
+		while (prefix[r + 1] <= k) r++;
+		return runs[r].first + (k - prefix[r]);
+	};
+	{
+		TaskGroup group(pool);
+		int per = (misplaced + blocks - 1) / std::max(1, blocks);
+		for (int first = 0; first < misplaced; first += per) {
+			int last = std::min(misplaced, first + per);
+			group.run([=, &large, &small, &largePrefix, &smallPrefix] {
+				size_t lr = 0, sr = 0;
+				for (int k = first; k < last; k++)
+					std::swap(arr[locate(large, largePrefix, k, lr)], arr[locate(small, smallPrefix, k, sr)]);
+			});
+		}
+	}
+	return p;
+}
+
+// Parallel three-way partition of [low, high]: takes the median of three
+// as pivot, returns its final index and sets eq to the start of the run of
+// keys equal to it, like partition() followed by equalRunStart().
+inline int parallelPartition(int arr[], int low, int high, ThreadPool* pool, int blocks, int& eq) {
+	medianToHigh(arr, low, high);
+	int pivot = arr[high];
+	int p = parallelSplit(arr, low, high, pool, blocks, [pivot](int x) { return x <= pivot; });
+	std::swap(arr[p], arr[high]);
+	eq = parallelSplit(arr, low, p, pool, blocks, [pivot](int x) { return x < pivot; });
+	return p;
+}
+
+// The top levels run their halves in parallel: on the pool when one is
+// given, otherwise on two fresh threads as the standalone program does.
+// The pivot is a median of three and the keys equal to it are left out of
+// both halves; below the forking levels the smaller half recurses and the
+// larger one loops, so the stack stays O(log n) even on repeated keys.
+inline void quickSort(int arr[], int low, int high, int depth = 0, ThreadPool* pool = nullptr,
+                      const SortTuning& tuning = SortTuning()) {
+	while (low < high) {
+		if (high - low < tuning.quickCutoff) {
+			insertionSort(arr, low, high);
+			return;
+		}
+		// Use threading for top levels only
+		bool fork = depth < tuning.quickSpawnDepth && high - low + 1 >= tuning.quickForkMin;
+		int pi, eq;
+		if (fork && pool && high - low + 1 >= tuning.quickPartitionMin) {
+			pi = parallelPartition(arr, low, high, pool, pool->concurrency(), eq);
+		} else {
+			medianToHigh(arr, low, high);
+			pi = partition(arr, low, high);
+			eq = equalRunStart(arr, low, pi);
+		}
+
+		if (fork && pool) {
+			TaskGroup group(pool);
+			group.run([=, &tuning] { quickSort(arr, low, eq - 1, depth + 1, pool, tuning); });
+			quickSort(arr, pi + 1, high, depth + 1, pool, tuning);
+			group.wait();
+			return;
+		} else if (fork) {
+			std::thread t1([=, &tuning] { quickSort(arr, low, eq - 1, depth + 1, nullptr, tuning); });
+			std::thread t2([=, &tuning] { quickSort(arr, pi + 1, high, depth + 1, nullptr, tuning); });
+			t1.join();
+			t2.join();
+			return;
+		}
+		depth++;
+		if (eq - low < high - pi) {
+			quickSort(arr, low, eq - 1, depth, pool, tuning);
+			low = pi + 1;
+		} else {
+			quickSort(arr, pi + 1, high, depth, pool, tuning);
+			high = eq - 1;
+		}
+	}
+}
+
+/************************************************************************
+ * HEAP SORT FUNCTIONS
+*************************************************************************/
+inline void heapify(int arr[], int n, int i) {
+	int largest = i;
+	int left = 2 * i + 1;
+	int right = 2 * i + 2;
+
+	if (left < n && arr[left] > arr[largest])
+		largest = left;
+	if (right < n && arr[right] > arr[largest])
+		largest = right;
+
+	if (largest != i) {
+		std::swap(arr[i], arr[largest]);
+		heapify(arr, n, largest);
+	}
+}
+
+inline void heapSort(int arr[], int n) {
+	// Build max heap
+	for (int i = n / 2 - 1; i >= 0; i--)
+		heapify(arr, n, i);
+
+	// Extract elements from heap
+	for (int i = n - 1; i > 0; i--) {
+		std::swap(arr[0], arr[i]);
+		heapify(arr, i, 0);
+	}
+}
+
+/************************************************************************
+ * RADIX SORT FUNCTIONS
+*************************************************************************/
+inline int getMax(int arr[], int n) {
+	int max = arr[0];
+	for (int i = 1; i < n; i++)
+		if (arr[i] > max)
+			max = arr[i];
+	return max;
+}
+
+inline int getMin(int arr[], int n) {
+	int min = arr[0];
+	for (int i = 1; i < n; i++)
+		if (arr[i] < min)
+			min = arr[i];
+	return min;
+}
+
+// Digits are taken from x - minValue computed in unsigned arithmetic, which
+// preserves order and keeps every digit in range for negative inputs too.
+inline void countSort(int arr[], int n, int shift, int bits, int minValue) {
+	int* output = new int[n];
+	uint32_t mask = (1u << bits) - 1;
+	std::vector<int> count(mask + 1, 0);
+	auto digit = [&](int x) { return ((uint32_t)x - (uint32_t)minValue) >> shift & mask; };
+
+	for (int i = 0; i < n; i++)
+		count[digit(arr[i])]++;
+
+	for (uint32_t i = 1; i <= mask; i++)
+		count[i] += count[i - 1];
+
+	for (int i = n - 1; i >= 0; i--) {
+		output[count[digit(arr[i])] - 1] = arr[i];
+		count[digit(arr[i])]--;
+	}
+
+	for (int i = 0; i < n; i++)
+		arr[i] = output[i];
+
+	delete[] output;
+}
+
+inline void radixSort(int arr[], int n, const SortTuning& tuning = SortTuning()) {
+	if (n <= 1) return;
+	int bits = std::clamp(tuning.radixBits, 1, 16);
+	int minValue = getMin(arr, n);
+	uint64_t span = (uint32_t)getMax(arr, n) - (uint32_t)minValue;
+	for (int shift = 0; shift < 32 && (span >> shift) > 0; shift += bits)
+		countSort(arr, n, shift, bits, minValue);
+}
+
+/************************************************************************
+ * BITONIC SORT FUNCTIONS
+*************************************************************************/
+inline void compAndSwap(int arr[], int i, int j, int dir) {
+	if (dir == (arr[i] > arr[j]))
+		std::swap(arr[i], arr[j]);
+}
+
+// Merge a bitonic run of any length: compare across the largest power of
+// two below cnt, then merge both parts. For power-of-2 cnt this is the
+// classic half split.
+inline void bitonicMerge(int arr[], int low, int cnt, int dir) {
+	if (cnt > 1) {
+		int k = 1;
+		while (k * 2 < cnt) k *= 2;
+		for (int i = low; i < low + cnt - k; i++)
+			compAndSwap(arr, i, i + k, dir);
+		bitonicMerge(arr, low, k, dir);
+		bitonicMerge(arr, low + k, cnt - k, dir);
+	}
+}
+
+inline void bitonicSort(int arr[], int low, int cnt, int dir) {
+	if (cnt > 1) {
+		int k = cnt / 2;
+		bitonicSort(arr, low, k, !dir);
+		bitonicSort(arr, low + k, cnt - k, dir);
+		bitonicMerge(arr, low, cnt, dir);
+	}
+}
+
+/************************************************************************
+ * LIBRARY API
+*************************************************************************/
+struct SortResult {
+	long long above = 0;
+	long long equals = 0;
+	long long below = 0;
+};
+
+// Sort arr[0..n-1] with one algorithm on the calling thread (quick sort may
+// still fork onto the pool).
+inline void sortRange(int arr[], int n, Algorithm algorithm, ThreadPool* pool = nullptr,
+                      const SortTuning& tuning = SortTuning()) {
+	if (n <= 1) return;
+	switch (algorithm) {
+	case Algorithm::Merge: mergeSort(arr, 0, n - 1, tuning); break;
+	case Algorithm::Quick: quickSort(arr, 0, n - 1, 0, pool, tuning); break;
+	case Algorithm::Heap: heapSort(arr, n); break;
+	case Algorithm::Radix: radixSort(arr, n, tuning); break;
+	case Algorithm::Bitonic: bitonicSort(arr, 0, n, 1); break;
+	}
+}
+
+// Reusable sorting runtime. The pool is created once and shared by every
+// call; a call splits the span into chunks (one per thread unless the
+// tuning says otherwise), counts and sorts the chunks in parallel, then
+// merges them pairwise level by level.
+class Sorter {
+public:
+	explicit Sorter(unsigned threads = std::thread::hardware_concurrency(),
+	                const SortTuning& tuning = SortTuning())
+		: pool(std::max(1u, threads) - 1), tuning(tuning) {}
+
+	SortResult sort(std::span<int> data, Algorithm algorithm, int threshold) {
+		int n = data.size();
+		int* arr = data.data();
+		int wanted = tuning.chunks[(int)algorithm];
+		if (wanted <= 0) wanted = pool.concurrency();
+		int chunks = std::max(1, std::min(wanted, n / 2));
+		int chunkSize = n / chunks;
+		std::vector<SortResult> partial(chunks);
+		// Quick sort only forks onto the pool when it owns the whole span
+		ThreadPool* forkPool = chunks == 1 ? &pool : nullptr;
+
+		{
+			TaskGroup group(&pool);
+			for (int c = 0; c < chunks; c++) {
+				int low = c * chunkSize;
+				int high = (c == chunks - 1) ? n : low + chunkSize;
+				group.run([=, this, &partial] {
+					SortResult& counts = partial[c];
+					for (int i = low; i < high; i++) {
+						if (arr[i] > threshold) counts.above++;
+						else if (arr[i] == threshold) counts.equals++;
+						else counts.below++;
+					}
+					sortRange(arr + low, high - low, algorithm, forkPool, tuning);
+				});
+			}
+		}
+
+		for (int step = chunkSize; chunks > 1 && step < n; step *= 2) {
+			TaskGroup group(&pool);
+			for (int i = 0; i + step < n; i += 2 * step) {
+				int mid = i + step - 1;
+				int right = std::min(i + 2 * step - 1, n - 1);
+				group.run([=] { mergeH(arr, i, mid, right); });
+			}
+		}
+
+		SortResult result;
+		for (const auto& counts : partial) {
+			result.above += counts.above;
+			result.equals += counts.equals;
+			result.below += counts.below;
+		}
+		return result;
+	}
+
+	unsigned threads() const { return pool.concurrency(); }
+	const SortTuning& getTuning() const { return tuning; }
+	void setTuning(const SortTuning& t) { tuning = t; } // not while a sort is running
+
+private:
+	ThreadPool pool;
+	SortTuning tuning;
+};
+
+/************************************************************************
+ * AUTO-TUNING AND PROFILES
+*************************************************************************/
+struct HostInfo {
+	long l1dCache = 0; // bytes, 0 when the host does not report it
+	long l2Cache = 0;
+	long l3Cache = 0;
+	unsigned cores = 1;
+};
+
+inline HostInfo detectHost() {
+	HostInfo host;
+	host.cores = std::max(1u, std::thread::hardware_concurrency());
+#ifdef _SC_LEVEL1_DCACHE_SIZE
+	host.l1dCache = std::max(0L, sysconf(_SC_LEVEL1_DCACHE_SIZE));
+	host.l2Cache = std::max(0L, sysconf(_SC_LEVEL2_CACHE_SIZE));
+	host.l3Cache = std::max(0L, sysconf(_SC_LEVEL3_CACHE_SIZE));
+#endif
+	return host;
+}
+
+inline const char* algorithmKey(Algorithm algorithm) {
+	static const char* keys[ALGORITHM_COUNT] = {"merge", "quick", "heap", "radix", "bitonic"};
+	return keys[(int)algorithm];
+}
+
+// Profiles are plain key=value lines; unknown keys are ignored so older
+// binaries can read newer profiles.
+inline bool saveProfile(const std::string& path, const SortTuning& tuning, const HostInfo& host) {
+	std::ofstream out(path);
+	if (!out) return false;
+	out << "# psort tuning profile\n";
+	out << "cores=" << host.cores << "\n";
+	out << "l1d_cache=" << host.l1dCache << "\n";
+	out << "l2_cache=" << host.l2Cache << "\n";
+	out << "l3_cache=" << host.l3Cache << "\n";
+	out << "merge_cutoff=" << tuning.mergeCutoff << "\n";
+	out << "quick_cutoff=" << tuning.quickCutoff << "\n";
+	out << "quick_spawn_depth=" << tuning.quickSpawnDepth << "\n";
+	out << "quick_fork_min=" << tuning.quickForkMin << "\n";
+	out << "quick_partition_min=" << tuning.quickPartitionMin << "\n";
+	out << "quick_start_depth=" << tuning.quickStartDepth << "\n";
+	out << "radix_bits=" << tuning.radixBits << "\n";
+	for (int a = 0; a < ALGORITHM_COUNT; a++)
+		out << "chunks_" << algorithmKey((Algorithm)a) << "=" << tuning.chunks[a] << "\n";
+	return (bool)out;
+}
+
+// Values outside the ranges the sorter supports reject the whole profile;
+// a missing file returns false with `error` left empty.
+inline bool loadProfile(const std::string& path, SortTuning& tuning, std::string& error) {
+	std::ifstream in(path);
+	if (!in) return false;
+	SortTuning loaded = tuning;
+	struct Knob {
+		std::string key;
+		int* field;
+		int low, high;
+	};
+	std::vector<Knob> knobs = {
+		{"merge_cutoff", &loaded.mergeCutoff, 0, INT_MAX},
+		{"quick_cutoff", &loaded.quickCutoff, 0, INT_MAX},
+		{"quick_spawn_depth", &loaded.quickSpawnDepth, 0, 16},
+		{"quick_fork_min", &loaded.quickForkMin, 0, INT_MAX},
+		{"quick_partition_min", &loaded.quickPartitionMin, 1, INT_MAX},
+		{"quick_start_depth", &loaded.quickStartDepth, 0, 16},
+		{"radix_bits", &loaded.radixBits, 1, 16},
+	};
+	for (int a = 0; a < ALGORITHM_COUNT; a++)
+		knobs.push_back({std::string("chunks_") + algorithmKey((Algorithm)a), &loaded.chunks[a], 0, INT_MAX});
+
+	std::string line;
+	while (std::getline(in, line)) {
+		size_t eq = line.find('=');
+		if (line.empty() || line[0] == '#' || eq == std::string::npos) continue;
+		auto knob = std::find_if(knobs.begin(), knobs.end(), [&](const Knob& k) { return line.compare(0, eq, k.key) == 0; });
+		if (knob == knobs.end()) continue;
+
+		int value;
+		std::istringstream text(line.substr(eq + 1));
+		if (!(text >> value) || value < knob->low || value > knob->high) {
+			error = path + ": " + knob->key + " must be an integer in " + std::to_string(knob->low) + ".." +
+			        std::to_string(knob->high);
+			return false;
+		}
+		*knob->field = value;
+	}
+	tuning = loaded;
+	return true;
+}
+
+// Best-of-reps wall time of run(buffer) on fresh copies of input.
+template <class Run>
+double benchmark(const std::vector<int>& input, int reps, Run&& run) {
+	double best = 1e100;
+	std::vector<int> work;
+	for (int r = 0; r < reps; r++) {
+		work = input;
+		auto start = std::chrono::steady_clock::now();
+		run(work);
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+		best = std::min(best, elapsed.count());
+	}
+	return best;
+}
+
+// Try each candidate for one knob with the others fixed, keep the fastest.
+template <class Apply, class Run>
+void tuneKnob(const char* name, const std::vector<int>& candidates, SortTuning& tuning,
+              Apply&& apply, Run&& run, std::ostream* log) {
+	int bestValue = candidates.front();
+	double bestTime = 1e100;
+	for (int value : candidates) {
+		apply(tuning, value);
+		double t = run();
+		if (log) *log << "  " << name << "=" << value << ": " << t * 1000 << " ms\n";
+		if (t < bestTime) {
+			bestTime = t;
+			bestValue = value;
+		}
+	}
+	apply(tuning, bestValue);
+	if (log) *log << "  -> " << name << "=" << bestValue << "\n";
+}
+
+// Coordinate search over the knobs on a cache-sized random input. Serial
+// knobs (cutoffs, radix width) are timed on one thread's share of the
+// input; spawn granularity and chunk counts are timed through a Sorter.
+inline SortTuning autoTune(const HostInfo& host, std::ostream* log = nullptr) {
+	SortTuning tuning;
+	unsigned cores = std::max(1u, host.cores);
+	long cache = host.l3Cache ? host.l3Cache : host.l2Cache ? host.l2Cache : 8L << 20;
+	int n = std::clamp<long>(cache * 2 / (long)sizeof(int), 1L << 18, 1L << 21);
+	int share = std::max<int>(1 << 12, n / cores);
+
+	std::mt19937 rng(473);
+	std::uniform_int_distribution<int> dist(0, 1 << 30);
+	std::vector<int> input(n), chunk(share);
+	for (int& x : input) x = dist(rng);
+	for (int& x : chunk) x = dist(rng);
+	const int reps = 3;
+	Sorter sorter(cores, tuning);
+
+	std::vector<int> cutoffs = {0, 8, 16, 32, 64};
+	tuneKnob("merge_cutoff", cutoffs, tuning, [](SortTuning& t, int v) { t.mergeCutoff = v; },
+	         [&] { return benchmark(chunk, reps, [&](std::vector<int>& w) { mergeSort(w.data(), 0, share - 1, tuning); }); }, log);
+	tuneKnob("quick_cutoff", cutoffs, tuning, [](SortTuning& t, int v) { t.quickCutoff = v; },
+	         [&] { return benchmark(chunk, reps, [&](std::vector<int>& w) { quickSort(w.data(), 0, share - 1, tuning.quickSpawnDepth, nullptr, tuning); }); }, log);
+	tuneKnob("radix_bits", {4, 6, 8, 11, 16}, tuning, [](SortTuning& t, int v) { t.radixBits = v; },
+	         [&] { return benchmark(chunk, reps, [&](std::vector<int>& w) { radixSort(w.data(), share, tuning); }); }, log);
+
+	// Spawn granularity: whole-span quick sort forking onto the pool
+	tuning.chunks[(int)Algorithm::Quick] = 1;
+	std::vector<int> depths;
+	int maxDepth = 2;
+	while ((1u << (maxDepth - 2)) < cores) maxDepth++;
+	for (int d = 0; d <= maxDepth; d++) depths.push_back(d);
+	auto timeQuickOnPool = [&] {
+		sorter.setTuning(tuning);
+		return benchmark(input, reps, [&](std::vector<int>& w) { sorter.sort(w, Algorithm::Quick, 0); });
+	};
+	tuneKnob("quick_spawn_depth", depths, tuning, [](SortTuning& t, int v) { t.quickSpawnDepth = v; }, timeQuickOnPool, log);
+	tuneKnob("quick_fork_min", {0, 1 << 12, 1 << 15}, tuning, [](SortTuning& t, int v) { t.quickForkMin = v; }, timeQuickOnPool, log);
+	tuneKnob("quick_partition_min", {1 << 14, 1 << 16, 1 << 18, INT_MAX}, tuning,
+	         [](SortTuning& t, int v) { t.quickPartitionMin = v; }, timeQuickOnPool, log);
+
+	// The program's per-thread quick sorts fork with plain threads from this depth
+	std::vector<int> starts;
+	for (int d = 0; d <= tuning.quickSpawnDepth; d++) starts.push_back(d);
+	tuneKnob("quick_start_depth", starts, tuning, [](SortTuning& t, int v) { t.quickStartDepth = v; }, [&] {
+		return benchmark(input, reps, [&](std::vector<int>& w) {
+			std::vector<std::thread> threads;
+			int size = n / cores;
+			for (unsigned c = 0; c < cores; c++) {
+				int low = c * size, high = (c == cores - 1) ? n - 1 : low + size - 1;
+				threads.emplace_back([&, low, high] { quickSort(w.data(), low, high, tuning.quickStartDepth, nullptr, tuning); });
+			}
+			for (auto& t : threads) t.join();
+		});
+	}, log);
+
+	std::vector<int> chunkCounts = {1, (int)cores, 2 * (int)cores, 4 * (int)cores};
+	chunkCounts.erase(std::unique(chunkCounts.begin(), chunkCounts.end()), chunkCounts.end());
+	for (int a = 0; a < ALGORITHM_COUNT; a++) {
+		std::string knob = std::string("chunks_") + algorithmKey((Algorithm)a);
+		tuneKnob(knob.c_str(), chunkCounts, tuning, [a](SortTuning& t, int v) { t.chunks[a] = v; }, [&] {
+			sorter.setTuning(tuning);
+			return benchmark(input, reps, [&](std::vector<int>& w) { sorter.sort(w, (Algorithm)a, 0); });
+		}, log);
+	}
+	return tuning;
+}
+
+} // namespace psort
@@ -12,170 +12,36 @@
 #include <algorithm>
 #include <string>
 #include <cmath>
+#include <sstream>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <sys/mman.h>
+#include <sched.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "parallelsort.h"
 using namespace std;
+using psort::mergeH;
+using psort::mergeSort;
+using psort::partition;
+using psort::medianToHigh;
+using psort::equalRunStart;
+using psort::quickSort;
+using psort::heapify;
+using psort::heapSort;
+using psort::radixSort;
+using psort::bitonicSort;
 
 int AboveThreshold = 0, EqualsThreshold = 0, BelowThreshold = 0, TH;
+bool countInThreads = true; // false in shared mode: the input is classified once up front
+psort::SortTuning tuning;    // loaded at startup from --profile, or PROFILE_FILE when present
+const string PROFILE_FILE = "sort_profile.txt";
 mutex mtx_counter, mtx_cout;
 
-/************************************************************************
- * MERGE SORT FUNCTIONS
-*************************************************************************/
-void mergeH(int arrayA[], int LMIndex, int MidIndex, int RMIndex)
-{
-	int leftArraySize = MidIndex - LMIndex + 1;
-	int rightArraySize = RMIndex - MidIndex;
-	int* leftArray = new int[leftArraySize];
-	int* rightArray = new int[rightArraySize];
-	for (int i = 0; i < leftArraySize; i++)	leftArray[i] = arrayA[LMIndex + i];
-	for (int j = 0; j < rightArraySize; j++) rightArray[j] = arrayA[MidIndex + 1 + j];
-	int i = 0;
-	int j = 0;
-	int index = LMIndex;
-	while (i < leftArraySize && j < rightArraySize) 
-		arrayA[index++] = (leftArray[i] <= rightArray[j]) ? leftArray[i++] : rightArray[j++];
-	while (i < leftArraySize) arrayA[index++] = leftArray[i++];
-	while (j < rightArraySize) arrayA[index++] = rightArray[j++];
-	delete[] leftArray;
-	delete[] rightArray;
-}
-
-void mergeSort(int arrayA[], int LMIndex, int RMIndex) {
-	if (LMIndex >= RMIndex) return;
-	int MidIndex = LMIndex + (RMIndex - LMIndex) / 2;
-	mergeSort(arrayA, LMIndex, MidIndex);
-	mergeSort(arrayA, MidIndex + 1, RMIndex);
-	mergeH(arrayA, LMIndex, MidIndex, RMIndex);
-}
-
-/************************************************************************
- * QUICK SORT FUNCTIONS
-*************************************************************************/
-int partition(int arr[], int low, int high) {
-	int pivot = arr[high];
-	int i = low - 1;
-	for (int j = low; j < high; j++) {
-		if (arr[j] <= pivot) {
-			i++;
-			swap(arr[i], arr[j]);
-		}
-	}
-	swap(arr[i + 1], arr[high]);
-	return i + 1;
-}
-
-void quickSort(int arr[], int low, int high, int depth = 0) {
-	if (low < high) {
-		int pi = partition(arr, low, high);
-		
-		// Use threading for top levels only
-		if (depth < 2) {
-			thread t1(quickSort, arr, low, pi - 1, depth + 1);
-			thread t2(quickSort, arr, pi + 1, high, depth + 1);
-			t1.join();
-			t2.join();
-		} else {
-			quickSort(arr, low, pi - 1, depth + 1);
-			quickSort(arr, pi + 1, high, depth + 1);
-		}
-	}
-}
-
-/************************************************************************
- * HEAP SORT FUNCTIONS
-*************************************************************************/
-void heapify(int arr[], int n, int i) {
-	int largest = i;
-	int left = 2 * i + 1;
-	int right = 2 * i + 2;
-	
-	if (left < n && arr[left] > arr[largest])
-		largest = left;
-	if (right < n && arr[right] > arr[largest])
-		largest = right;
-	
-	if (largest != i) {
-		swap(arr[i], arr[largest]);
-		heapify(arr, n, largest);
-	}
-}
-
-void heapSort(int arr[], int n) {
-	// Build max heap
-	for (int i = n / 2 - 1; i >= 0; i--)
-		heapify(arr, n, i);
-	
-	// Extract elements from heap
-	for (int i = n - 1; i > 0; i--) {
-		swap(arr[0], arr[i]);
-		heapify(arr, i, 0);
-	}
-}
-
-/************************************************************************
- * RADIX SORT FUNCTIONS
-*************************************************************************/
-int getMax(int arr[], int n) {
-	int max = arr[0];
-	for (int i = 1; i < n; i++)
-		if (arr[i] > max)
-			max = arr[i];
-	return max;
-}
-
-void countSort(int arr[], int n, int exp) {
-	int* output = new int[n];
-	int count[10] = {0};
-	
-	for (int i = 0; i < n; i++)
-		count[(arr[i] / exp) % 10]++;
-	
-	for (int i = 1; i < 10; i++)
-		count[i] += count[i - 1];
-	
-	for (int i = n - 1; i >= 0; i--) {
-		output[count[(arr[i] / exp) % 10] - 1] = arr[i];
-		count[(arr[i] / exp) % 10]--;
-	}
-	
-	for (int i = 0; i < n; i++)
-		arr[i] = output[i];
-	
-	delete[] output;
-}
-
-void radixSort(int arr[], int n) {
-	int max = getMax(arr, n);
-	for (int exp = 1; max / exp > 0; exp *= 10)
-		countSort(arr, n, exp);
-}
-
 /************************************************************************
  * BITONIC SORT FUNCTIONS
 *************************************************************************/
-void compAndSwap(int arr[], int i, int j, int dir) {
-	if (dir == (arr[i] > arr[j]))
-		swap(arr[i], arr[j]);
-}
-
-void bitonicMerge(int arr[], int low, int cnt, int dir) {
-	if (cnt > 1) {
-		int k = cnt / 2;
-		for (int i = low; i < low + k; i++)
-			compAndSwap(arr, i, i + k, dir);
-		bitonicMerge(arr, low, k, dir);
-		bitonicMerge(arr, low + k, k, dir);
-	}
-}
-
-void bitonicSort(int arr[], int low, int cnt, int dir) {
-	if (cnt > 1) {
-		int k = cnt / 2;
-		bitonicSort(arr, low, k, 1);
-		bitonicSort(arr, low + k, k, 0);
-		bitonicMerge(arr, low, cnt, dir);
-	}
-}
-
 void bitonicSortWrapper(int arr[], int n) {
 	// Pad to next power of 2 if needed
 	int paddedSize = 1;
@@ -193,12 +59,7 @@ void bitonicSortWrapper(int arr[], int n) {
 /************************************************************************
  * THREAD TASK FUNCTIONS (WITH MUTEX PROTECTION)
 *************************************************************************/
-void threadTaskMerge(int threadID, int* arr, int low, int high) {
-	{
-		lock_guard<mutex> lock(mtx_cout);
-		cout << "Merge Sort Thread " << threadID << ": low = " << low << ", high = " << high << endl;
-	}
-	
+void countThreshold(int* arr, int low, int high) {
 	// Count elements with mutex protection
 	for (int i = low; i <= high; i++) {
 		lock_guard<mutex> lock(mtx_counter);
@@ -206,8 +67,17 @@ void threadTaskMerge(int threadID, int* arr, int low, int high) {
 		else if (arr[i] == TH) EqualsThreshold++;
 		else BelowThreshold++;
 	}
+}
+
+void threadTaskMerge(int threadID, int* arr, int low, int high) {
+	{
+		lock_guard<mutex> lock(mtx_cout);
+		cout << "Merge Sort Thread " << threadID << ": low = " << low << ", high = " << high << endl;
+	}
 	
-	mergeSort(arr, low, high);
+	if (countInThreads) countThreshold(arr, low, high);
+	
+	mergeSort(arr, low, high, tuning);
 }
 
 void threadTaskQuick(int threadID, int* arr, int low, int high) {
@@ -216,15 +86,9 @@ void threadTaskQuick(int threadID, int* arr, int low, int high) {
 		cout << "Quick Sort Thread " << threadID << ": low = " << low << ", high = " << high << endl;
 	}
 	
-	// Count elements with mutex protection
-	for (int i = low; i <= high; i++) {
-		lock_guard<mutex> lock(mtx_counter);
-		if (arr[i] > TH) AboveThreshold++;
-		else if (arr[i] == TH) EqualsThreshold++;
-		else BelowThreshold++;
-	}
+	if (countInThreads) countThreshold(arr, low, high);
 	
-	quickSort(arr, low, high, 2); // Start at depth 2 to avoid too many threads
+	quickSort(arr, low, high, tuning.quickStartDepth, nullptr, tuning); // Default start depth 2 avoids too many threads
 }
 
 void threadTaskHeap(int threadID, int* arr, int low, int high) {
@@ -233,13 +97,7 @@ void threadTaskHeap(int threadID, int* arr, int low, int high) {
 		cout << "Heap Sort Thread " << threadID << ": low = " << low << ", high = " << high << endl;
 	}
 	
-	// Count elements with mutex protection
-	for (int i = low; i <= high; i++) {
-		lock_guard<mutex> lock(mtx_counter);
-		if (arr[i] > TH) AboveThreshold++;
-		else if (arr[i] == TH) EqualsThreshold++;
-		else BelowThreshold++;
-	}
+	if (countInThreads) countThreshold(arr, low, high);
 	
 	// Heap sort on the chunk
 	int size = high - low + 1;
@@ -252,17 +110,11 @@ void threadTaskRadix(int threadID, int* arr, int low, int high) {
 		cout << "Radix Sort Thread " << threadID << ": low = " << low << ", high = " << high << endl;
 	}
 	
-	// Count elements with mutex protection
-	for (int i = low; i <= high; i++) {
-		lock_guard<mutex> lock(mtx_counter);
-		if (arr[i] > TH) AboveThreshold++;
-		else if (arr[i] == TH) EqualsThreshold++;
-		else BelowThreshold++;
-	}
+	if (countInThreads) countThreshold(arr, low, high);
 	
 	// Radix sort on the chunk
 	int size = high - low + 1;
-	radixSort(arr + low, size);
+	radixSort(arr + low, size, tuning);
 }
 
 void threadTaskBitonic(int threadID, int* arr, int low, int high) {
@@ -271,13 +123,7 @@ void threadTaskBitonic(int threadID, int* arr, int low, int high) {
 		cout << "Bitonic Sort Thread " << threadID << ": low = " << low << ", high = " << high << endl;
 	}
 	
-	// Count elements with mutex protection
-	for (int i = low; i <= high; i++) {
-		lock_guard<mutex> lock(mtx_counter);
-		if (arr[i] > TH) AboveThreshold++;
-		else if (arr[i] == TH) EqualsThreshold++;
-		else BelowThreshold++;
-	}
+	if (countInThreads) countThreshold(arr, low, high);
 	
 	// Bitonic sort on the chunk
 	int size = high - low + 1;
@@ -285,34 +131,336 @@ void threadTaskBitonic(int threadID, int* arr, int low, int high) {
 }
 
 /************************************************************************
- * MAIN FUNCTION
+ * SHARED-INPUT MODE (CLASSIFY ONCE, POOLED COPIES)
 *************************************************************************/
-void runSortingAlgorithm(const string& algoName, vector<int> data, int T, int N, 
-                         void (*threadFunc)(int, int*, int, int)) {
-	{
-		lock_guard<mutex> lock(mtx_cout);
-		cout << "\n========================================" << endl;
-		cout << "Running " << algoName << " (SAFE VERSION)" << endl;
-		cout << "========================================" << endl;
+// Fixed set of N-int buffers reused across runs. Buffers are mapped once,
+// advised for transparent huge pages and touched up front so the sorts never
+// take page faults. acquire() blocks while every buffer is in flight, which
+// bounds peak memory to (buffers x N) ints no matter how many algorithms run.
+class BufferPool {
+public:
+	BufferPool(int count, int n) : bytes(max(1, n) * sizeof(int)) {
+		for (int i = 0; i < count; i++) {
+			void* p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+			if (p == MAP_FAILED) {
+				p = new int[max(1, n)];
+				owned.push_back(false);
+			} else {
+#ifdef MADV_HUGEPAGE
+				madvise(p, bytes, MADV_HUGEPAGE);
+#endif
+				owned.push_back(true);
+			}
+			memset(p, 0, bytes); // pre-fault every page
+			buffers.push_back(static_cast<int*>(p));
+			freeList.push_back(static_cast<int*>(p));
+		}
 	}
-	
-	// Reset counters (no need for mutex here - single-threaded at this point)
+
+	~BufferPool() {
+		for (size_t i = 0; i < buffers.size(); i++) {
+			if (owned[i]) munmap(buffers[i], bytes);
+			else delete[] buffers[i];
+		}
+	}
+
+	int* acquire() {
+		unique_lock<mutex> lock(mtx);
+		cv.wait(lock, [this] { return !freeList.empty(); });
+		int* p = freeList.back();
+		freeList.pop_back();
+		return p;
+	}
+
+	void release(int* p) {
+		{
+			lock_guard<mutex> lock(mtx);
+			freeList.push_back(p);
+		}
+		cv.notify_one();
+	}
+
+private:
+	size_t bytes;
+	vector<int*> buffers;
+	vector<bool> owned;
+	vector<int*> freeList;
+	mutex mtx;
+	condition_variable cv;
+};
+
+struct SortAlgorithm {
+	string name;
+	void (*threadFunc)(int, int*, int, int);
+	psort::Algorithm algorithm;
+};
+
+// Classify the read-only input once with T threads. Each thread counts its own
+// chunk and takes the counter mutex once to publish the totals.
+void classifyOnce(const vector<int>& data, int T, int N) {
 	AboveThreshold = 0;
 	EqualsThreshold = 0;
 	BelowThreshold = 0;
 	
 	vector<thread> threads;
 	int chunkSize = N / T;
-	
-	for (int i = 0; i < T; i++) {
+	for (int i = 0; i < T && i < N; i++) {
 		int low = i * chunkSize;
 		int high = (i == T - 1) ? N - 1 : (low + chunkSize - 1);
+		threads.emplace_back([&data, low, high] {
+			int above = 0, equals = 0, below = 0;
+			for (int j = low; j <= high; j++) {
+				if (data[j] > TH) above++;
+				else if (data[j] == TH) equals++;
+				else below++;
+			}
+			lock_guard<mutex> lock(mtx_counter);
+			AboveThreshold += above;
+			EqualsThreshold += equals;
+			BelowThreshold += below;
+		});
+	}
+	for (auto& t : threads) t.join();
+}
+
+// Pin the calling thread to the slot-th of `slots` disjoint slices of the
+// cores this process may run on. Threads it spawns inherit the mask.
+void pinToCoreSlice(int slot, int slots) {
+	cpu_set_t allowed;
+	if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) return;
+	vector<int> cores;
+	for (int c = 0; c < CPU_SETSIZE; c++)
+		if (CPU_ISSET(c, &allowed)) cores.push_back(c);
+	if ((int)cores.size() < slots) return;
+	
+	int per = cores.size() / slots;
+	int first = slot * per;
+	int last = (slot == slots - 1) ? cores.size() : first + per;
+	cpu_set_t mine;
+	CPU_ZERO(&mine);
+	for (int c = first; c < last; c++) CPU_SET(cores[c], &mine);
+	pthread_setaffinity_np(pthread_self(), sizeof(mine), &mine);
+}
+
+/************************************************************************
+ * SELECTION / TOP-K QUERIES (NO FULL SORT)
+*************************************************************************/
+const int SELECT_PARALLEL_CUTOFF = 1 << 16;
+
+// k-th smallest (0-based) of arr[low..high]; reorders the range.
+int quickSelect(int arr[], int low, int high, int k) {
+	while (low < high) {
+		medianToHigh(arr, low, high);
+		int pi = partition(arr, low, high);
+		if (k > pi) {
+			low = pi + 1;
+			continue;
+		}
+		int eq = equalRunStart(arr, low, pi);
+		if (k >= eq) return arr[pi];
+		high = eq - 1;
+	}
+	return arr[low];
+}
+
+// Parallel quickselect. Each round the T threads count their chunk against
+// one pivot, then copy only the side that holds rank k into the next round's
+// buffer, so the work shrinks geometrically and the total stays O(N).
+int parallelSelect(vector<int> work, int k, int T) {
+	int n = work.size();
+	vector<int> next;
+	while (T > 1 && n > SELECT_PARALLEL_CUTOFF) {
+		int a = work[0], b = work[n / 2], c = work[n - 1];
+		int pivot = max(min(a, b), min(max(a, b), c));
+		int chunkSize = (n + T - 1) / T;
+		vector<int> lessCount(T, 0), equalCount(T, 0);
+		
+		vector<thread> threads;
+		for (int t = 0; t < T; t++) {
+			threads.emplace_back([&, t] {
+				int low = t * chunkSize, high = min(n, low + chunkSize);
+				int less = 0, equal = 0;
+				for (int i = low; i < high; i++) {
+					if (work[i] < pivot) less++;
+					else if (work[i] == pivot) equal++;
+				}
+				lessCount[t] = less;
+				equalCount[t] = equal;
+			});
+		}
+		for (auto& t : threads) t.join();
+		threads.clear();
+		
+		int totalLess = 0, totalEqual = 0;
+		for (int t = 0; t < T; t++) {
+			totalLess += lessCount[t];
+			totalEqual += equalCount[t];
+		}
+		if (k >= totalLess && k < totalLess + totalEqual) return pivot;
+		bool keepLess = k < totalLess;
+		if (!keepLess) k -= totalLess + totalEqual;
+		
+		vector<int> offset(T + 1, 0);
+		for (int t = 0; t < T; t++) {
+			int low = t * chunkSize, high = min(n, low + chunkSize);
+			int kept = keepLess ? lessCount[t] : max(0, high - low) - lessCount[t] - equalCount[t];
+			offset[t + 1] = offset[t] + kept;
+		}
+		next.resize(offset[T]);
+		for (int t = 0; t < T; t++) {
+			threads.emplace_back([&, t] {
+				int low = t * chunkSize, high = min(n, low + chunkSize);
+				int out = offset[t];
+				for (int i = low; i < high; i++) {
+					if (keepLess ? work[i] < pivot : work[i] > pivot) next[out++] = work[i];
+				}
+			});
+		}
+		for (auto& t : threads) t.join();
+		swap(work, next);
+		n = work.size();
+	}
+	return quickSelect(work.data(), 0, n - 1, k);
+}
+
+// Answer every rank in ranks[rlo..rhi] (sorted ascending) with one recursive
+// partitioning pass: each partition step splits the pending ranks between
+// its two sides, so m percentiles cost O(N log m) instead of m selections.
+void multiSelect(int arr[], int low, int high, const vector<int>& ranks, int rlo, int rhi,
+                 vector<int>& answers) {
+	while (rlo <= rhi) {
+		if (low >= high) {
+			for (int r = rlo; r <= rhi; r++) answers[r] = arr[low];
+			return;
+		}
+		medianToHigh(arr, low, high);
+		int pi = partition(arr, low, high);
+		int eq = equalRunStart(arr, low, pi);
+		int split = lower_bound(ranks.begin() + rlo, ranks.begin() + rhi + 1, eq) - ranks.begin();
+		int after = split;
+		while (after <= rhi && ranks[after] <= pi) answers[after++] = arr[pi];
+		multiSelect(arr, low, eq - 1, ranks, rlo, split - 1, answers);
+		rlo = after;
+		low = pi + 1;
+	}
+}
+
+// The k smallest values, ascending. parallelSelect finds the k-th smallest,
+// the T threads count and then copy their chunk's values below it, and the
+// remaining slots are copies of it; only those k values are heap-sorted.
+// O(N + k log k) time, O(N) space for the selection's working copy.
+vector<int> topKSmallest(const vector<int>& data, int k, int T) {
+	int N = data.size();
+	k = min(k, N);
+	if (k <= 0) return {};
+	int kth = parallelSelect(data, k - 1, T);
+	int chunkSize = (N + T - 1) / T;
+	vector<int> lessCount(T, 0);
+	
+	vector<thread> threads;
+	for (int t = 0; t < T; t++) {
+		threads.emplace_back([&, t] {
+			int low = t * chunkSize, high = min(N, low + chunkSize);
+			int less = 0;
+			for (int i = low; i < high; i++)
+				if (data[i] < kth) less++;
+			lessCount[t] = less;
+		});
+	}
+	for (auto& t : threads) t.join();
+	threads.clear();
+	
+	vector<int> offset(T + 1, 0);
+	for (int t = 0; t < T; t++) offset[t + 1] = offset[t] + lessCount[t];
+	vector<int> smallest(k, kth);  // fewer than k values are below kth
+	for (int t = 0; t < T; t++) {
+		threads.emplace_back([&, t] {
+			int low = t * chunkSize, high = min(N, low + chunkSize);
+			int out = offset[t];
+			for (int i = low; i < high; i++)
+				if (data[i] < kth) smallest[out++] = data[i];
+		});
+	}
+	for (auto& t : threads) t.join();
+	
+	heapSort(smallest.data(), k);
+	return smallest;
+}
+
+void runQueries(const vector<int>& data, int T, int N, int selectRank, int topK,
+                const vector<double>& percentiles) {
+	ofstream out("out_safe_Query.txt");
+	
+	classifyOnce(data, T, N);
+	cout << "Query - Above Threshold = " << AboveThreshold << endl;
+	cout << "Query - Equals Threshold = " << EqualsThreshold << endl;
+	cout << "Query - Below Threshold = " << BelowThreshold << endl;
+	out << "Above=" << AboveThreshold << " Equals=" << EqualsThreshold << " Below=" << BelowThreshold << "\n";
+	
+	if (selectRank >= 0 && selectRank < N) {
+		int value = parallelSelect(data, selectRank, T);
+		cout << "Query - Element of rank " << selectRank << " = " << value << endl;
+		out << "select " << selectRank << " = " << value << "\n";
+	}
+	
+	if (topK > 0) {
+		vector<int> smallest = topKSmallest(data, topK, T);
+		cout << "Query - " << smallest.size() << " smallest values written" << endl;
+		out << "smallest " << smallest.size() << ":";
+		for (int x : smallest) out << " " << x;
+		out << "\n";
+	}
+	
+	if (!percentiles.empty() && N > 0) {
+		// Nearest-rank percentiles, answered together on one working copy
+		vector<int> ranks;
+		for (double p : percentiles) {
+			int rank = (int)ceil(p / 100.0 * N) - 1;
+			ranks.push_back(min(max(rank, 0), N - 1));
+		}
+		vector<int> sortedRanks = ranks;
+		sort(sortedRanks.begin(), sortedRanks.end());
+		sortedRanks.erase(unique(sortedRanks.begin(), sortedRanks.end()), sortedRanks.end());
+		vector<int> answers(sortedRanks.size());
+		vector<int> work = data;
+		multiSelect(work.data(), 0, N - 1, sortedRanks, 0, sortedRanks.size() - 1, answers);
+		
+		for (size_t i = 0; i < percentiles.size(); i++) {
+			int pos = lower_bound(sortedRanks.begin(), sortedRanks.end(), ranks[i]) - sortedRanks.begin();
+			cout << "Query - p" << percentiles[i] << " = " << answers[pos] << endl;
+			out << "p" << percentiles[i] << " = " << answers[pos] << "\n";
+		}
+	}
+	
+	out.close();
+	cout << "Output written to out_safe_Query.txt" << endl;
+}
+
+/************************************************************************
+ * MAIN FUNCTION
+*************************************************************************/
+// Sort data[0..N-1] in chunks with the algorithm's threadFunc, then merge
+// the chunks. There is one chunk per thread unless the tuning profile sets a
+// chunk count for the algorithm; thread i then sorts chunks i, i + T, ...
+void sortChunks(int* data, int T, int N, const SortAlgorithm& algo) {
+	int chunks = T;
+	if (tuning.chunks[(int)algo.algorithm] > 0) chunks = max(1, min(tuning.chunks[(int)algo.algorithm], N));
+	vector<thread> threads;
+	int chunkSize = N / chunks;
+	
+	for (int i = 0; i < min(T, chunks); i++) {
 		if (i >= N) {
 			lock_guard<mutex> lock(mtx_cout);
 			cout << "Thread " << i << ": No work to do." << endl;
 			continue;
 		}
-		threads.emplace_back(threadFunc, i, data.data(), low, high);
+		threads.emplace_back([=, threadFunc = algo.threadFunc] {
+			for (int c = i; c < chunks; c += T) {
+				int low = c * chunkSize;
+				int high = (c == chunks - 1) ? N - 1 : (low + chunkSize - 1);
+				threadFunc(c, data, low, high);
+			}
+		});
 	}
 	
 	for (auto& t : threads) t.join();
@@ -323,26 +471,20 @@ void runSortingAlgorithm(const string& algoName, vector<int> data, int T, int N,
 		for (int i = 0; i + step < N; i += 2 * step) {
 			int mid = i + step - 1;
 			int right = min(i + 2 * step - 1, N - 1);
-			mergeH(data.data(), i, mid, right);
+			mergeH(data, i, mid, right);
 		}
 		step *= 2;
 	}
-	
-	{
-		lock_guard<mutex> lock(mtx_cout);
-		cout << algoName << " - Above Threshold = " << AboveThreshold << endl;
-		cout << algoName << " - Equals Threshold = " << EqualsThreshold << endl;
-		cout << algoName << " - Below Threshold = " << BelowThreshold << endl;
-	}
-	
-	// Write output
+}
+
+void writeSorted(const string& algoName, const int* data, int N) {
 	string filename = "out_safe_" + algoName + ".txt";
 	for (char& c : filename) {
 		if (c == ' ') c = '_';
 	}
 	ofstream out(filename);
 	out << "Sorted array using " << algoName << " (SAFE VERSION):\n";
-	for (int x : data) out << x << " ";
+	for (int i = 0; i < N; i++) out << data[i] << " ";
 	out << endl;
 	out.close();
 	
@@ -352,14 +494,144 @@ void runSortingAlgorithm(const string& algoName, vector<int> data, int T, int N,
 	}
 }
 
+void runSortingAlgorithm(const SortAlgorithm& algo, vector<int> data, int T, int N) {
+	const string& algoName = algo.name;
+	{
+		lock_guard<mutex> lock(mtx_cout);
+		cout << "\n========================================" << endl;
+		cout << "Running " << algoName << " (SAFE VERSION)" << endl;
+		cout << "========================================" << endl;
+	}
+	
+	// Reset counters (no need for mutex here - single-threaded at this point)
+	AboveThreshold = 0;
+	EqualsThreshold = 0;
+	BelowThreshold = 0;
+	
+	sortChunks(data.data(), T, N, algo);
+	
+	{
+		lock_guard<mutex> lock(mtx_cout);
+		cout << algoName << " - Above Threshold = " << AboveThreshold << endl;
+		cout << algoName << " - Equals Threshold = " << EqualsThreshold << endl;
+		cout << algoName << " - Below Threshold = " << BelowThreshold << endl;
+	}
+	
+	writeSorted(algoName, data.data(), N);
+}
+
+// Shared mode: classify once, then give each algorithm a pooled copy of the
+// read-only input. With concurrency > 1 up to that many algorithms run at
+// once, each pinned to its own slice of the cores.
+void runAllShared(const vector<SortAlgorithm>& algorithms, const vector<int>& data,
+                  int T, int N, int concurrency) {
+	classifyOnce(data, T, N);
+	countInThreads = false;
+	cout << "Shared input classified once: Above = " << AboveThreshold
+	     << ", Equals = " << EqualsThreshold << ", Below = " << BelowThreshold << endl;
+	
+	concurrency = max(1, min(concurrency, (int)algorithms.size()));
+	BufferPool pool(concurrency, N);
+	atomic<int> next(0);
+	
+	auto runner = [&](int slot) {
+		if (concurrency > 1) pinToCoreSlice(slot, concurrency);
+		for (int a = next++; a < (int)algorithms.size(); a = next++) {
+			const SortAlgorithm& algo = algorithms[a];
+			{
+				lock_guard<mutex> lock(mtx_cout);
+				cout << "\n========================================" << endl;
+				cout << "Running " << algo.name << " (SAFE VERSION, shared input)" << endl;
+				cout << "========================================" << endl;
+			}
+			
+			int* buffer = pool.acquire();
+			copy(data.begin(), data.end(), buffer);
+			sortChunks(buffer, T, N, algo);
+			
+			{
+				lock_guard<mutex> lock(mtx_cout);
+				cout << algo.name << " - Above Threshold = " << AboveThreshold << endl;
+				cout << algo.name << " - Equals Threshold = " << EqualsThreshold << endl;
+				cout << algo.name << " - Below Threshold = " << BelowThreshold << endl;
+			}
+			writeSorted(algo.name, buffer, N);
+			pool.release(buffer);
+		}
+	};
+	
+	vector<thread> runners;
+	for (int slot = 1; slot < concurrency; slot++) runners.emplace_back(runner, slot);
+	runner(0);
+	for (auto& t : runners) t.join();
+}
+
 int main(int argc, char* argv[]) {
-	if (argc != 2) {
-		cout << "Usage: " << argv[0] << " <number_of_threads>" << endl;
+	if (argc >= 2 && string(argv[1]) == "--autotune") {
+		string path = argc >= 3 ? argv[2] : PROFILE_FILE;
+		psort::HostInfo host = psort::detectHost();
+		cout << "Auto-tuning for " << host.cores << " cores, L1d=" << host.l1dCache
+		     << ", L2=" << host.l2Cache << ", L3=" << host.l3Cache << " bytes" << endl;
+		psort::SortTuning tuned = psort::autoTune(host, &cout);
+		if (!psort::saveProfile(path, tuned, host)) {
+			cout << "Error: Cannot write " << path << endl;
+			return 1;
+		}
+		cout << "Profile written to " << path << endl;
+		return 0;
+	}
+	
+	bool shared = false;
+	int inflight = 1;
+	bool concurrent = false;
+	bool query = false;
+	int selectRank = -1, topK = 0;
+	vector<double> percentiles;
+	string profileFile;
+	for (int i = 2; i < argc; i++) {
+		string arg = argv[i];
+		if (arg == "--shared") shared = true;
+		else if (arg == "--concurrent") concurrent = true;
+		else if (arg == "--inflight" && i + 1 < argc) {
+			// A bound on copies in flight only matters when they run at once
+			inflight = max(1, stoi(argv[++i]));
+			concurrent = true;
+		}
+		else if (arg == "--query") query = true;
+		else if (arg == "--profile" && i + 1 < argc) profileFile = argv[++i];
+		else if (arg == "--select" && i + 1 < argc) selectRank = stoi(argv[++i]);
+		else if (arg == "--topk" && i + 1 < argc) topK = stoi(argv[++i]);
+		else if (arg == "--percentiles" && i + 1 < argc) {
+			stringstream list(argv[++i]);
+			string item;
+			while (getline(list, item, ',')) percentiles.push_back(stod(item));
+		}
+		else {
+			argc = 0;
+			break;
+		}
+	}
+	if (concurrent && !shared) argc = 0;
+	if (argc < 2) {
+		cout << "Usage: " << argv[0] << " <number_of_threads> [--shared [--concurrent] [--inflight K]] [--profile FILE]" << endl;
+		cout << "       " << argv[0] << " <number_of_threads> --query [--select K] [--topk K] [--percentiles P1,P2,...]" << endl;
+		cout << "       " << argv[0] << " --autotune [profile_file]" << endl;
 		return 1;
 	}
 	
 	int T = stoi(argv[1]);
 	
+	// An explicit --profile must load; the default one is optional
+	bool explicitProfile = !profileFile.empty();
+	if (!explicitProfile) profileFile = PROFILE_FILE;
+	string profileError;
+	if (psort::loadProfile(profileFile, tuning, profileError)) {
+		cout << "Loaded tuning profile " << profileFile << endl;
+	} else if (!profileError.empty() || explicitProfile) {
+		cout << "Error: " << (profileError.empty() ? "Cannot open " + profileFile : profileError) << endl;
+		return 1;
+	}
+	
 	ifstream in("in.txt");
 	if (!in) {
 		cout << "Error: Cannot open in.txt" << endl;
@@ -377,15 +649,30 @@ int main(int argc, char* argv[]) {
 		return 1;
 	}
 	
+	if (query) {
+		cout << "Main: Answering queries with N=" << N << ", TH=" << TH << ", Threads=" << T << endl;
+		runQueries(data, T, N, selectRank, topK, percentiles);
+		return 0;
+	}
+	
 	cout << "Main: Starting sorting with N=" << N << ", TH=" << TH << ", Threads=" << T << endl;
 	cout << "VERSION: SAFE (with mutex synchronization)" << endl;
 	
+	vector<SortAlgorithm> algorithms = {
+		{"Merge_Sort", threadTaskMerge, psort::Algorithm::Merge},
+		{"Quick_Sort", threadTaskQuick, psort::Algorithm::Quick},
+		{"Heap_Sort", threadTaskHeap, psort::Algorithm::Heap},
+		{"Radix_Sort", threadTaskRadix, psort::Algorithm::Radix},
+		{"Bitonic_Sort", threadTaskBitonic, psort::Algorithm::Bitonic},
+	};
+	
 	// Run all sorting algorithms
-	runSortingAlgorithm("Merge_Sort", data, T, N, threadTaskMerge);
-	runSortingAlgorithm("Quick_Sort", data, T, N, threadTaskQuick);
-	runSortingAlgorithm("Heap_Sort", data, T, N, threadTaskHeap);
-	runSortingAlgorithm("Radix_Sort", data, T, N, threadTaskRadix);
-	runSortingAlgorithm("Bitonic_Sort", data, T, N, threadTaskBitonic);
+	if (shared) {
+		runAllShared(algorithms, data, T, N, concurrent ? inflight : 1);
+	} else {
+		for (const auto& algo : algorithms)
+			runSortingAlgorithm(algo, data, T, N);
+	}
 	
 	cout << "\n========================================" << endl;
 	cout << "All sorting algorithms completed (SAFE)!" << endl;